@@ -67,7 +67,8 @@ public:
 
 	// Returns a read-only DC. Must be called between BeginDraw() and EndDraw(). GetDC() must be
 	// matched by a corresponding call to ReleaseDC(). While in the Gdiplus context, non-const
-	// member functions of this class must not be called.
+	// member functions of this class must not be called. The DC is owned by the canvas and is
+	// reused until the canvas is resized.
 	virtual HDC GetDC() = 0;
 	virtual HBITMAP GetBitmap() = 0;
 	virtual void ReleaseDC(HDC dc) = 0;
@@ -82,6 +83,11 @@ public:
 	virtual void ResetTransform() = 0;
 	virtual void RotateTransform(float angle, float x, float y, float dx, float dy) = 0;
 
+	// Restricts drawing, including Clear(), to |rect| (in canvas coordinates regardless of the
+	// current transform) until ResetClip() is called. Resize() also resets the clip.
+	virtual void SetClip(const Gdiplus::Rect& rect) = 0;
+	virtual void ResetClip() = 0;
+
 	virtual void SetAntiAliasing(bool enable) = 0;
 	virtual void SetTextAntiAliasing(bool enable) = 0;
 
@@ -53,13 +53,18 @@ Microsoft::WRL::ComPtr<IWICImagingFactory> CanvasD2D::c_WICFactory;
 
 CanvasD2D::CanvasD2D() : Canvas(),
 	m_Bitmap(),
+	m_DC(),
+	m_OldDCBitmap(),
 	m_TextAntiAliasing(false),
-	m_CanUseAxisAlignClip(false)
+	m_CanUseAxisAlignClip(false),
+	m_Clip(),
+	m_HasClip(false)
 {
 }
 
 CanvasD2D::~CanvasD2D()
 {
+	DisposeDC();
 	Finalize();
 }
 
@@ -127,7 +132,10 @@ void CanvasD2D::Resize(int w, int h)
 	__super::Resize(w, h);
 
 	m_Target.Reset();
+	m_HasClip = false;
 
+	// The bitmap cannot be deleted while it is selected into the DC.
+	DisposeDC();
 	m_Bitmap.Resize(w, h);
 
 	m_GdipBitmap.reset(new Gdiplus::Bitmap(w, h, w * 4, PixelFormat32bppPARGB, m_Bitmap.GetData()));
@@ -173,6 +181,12 @@ bool CanvasD2D::BeginTargetDraw()
 
 		m_Target->BeginDraw();
 
+		if (m_HasClip)
+		{
+			// The target transform is still the identity here.
+			m_Target->PushAxisAlignedClip(ToRectF(m_Clip), D2D1_ANTIALIAS_MODE_ALIASED);
+		}
+
 		// Apply any transforms that occurred before creation of |m_Target|.
 		UpdateTargetTransform();
 
@@ -186,6 +200,11 @@ void CanvasD2D::EndTargetDraw()
 {
 	if (m_Target)
 	{
+		if (m_HasClip)
+		{
+			m_Target->PopAxisAlignedClip();
+		}
+
 		m_Target->EndDraw();
 		m_Target.Reset();
 	}
@@ -205,9 +224,13 @@ HDC CanvasD2D::GetDC()
 {
 	EndTargetDraw();
 
-	HDC dcMemory = CreateCompatibleDC(nullptr);
-	SelectObject(dcMemory, m_Bitmap.GetHandle());
-	return dcMemory;
+	if (!m_DC)
+	{
+		m_DC = CreateCompatibleDC(nullptr);
+		m_OldDCBitmap = SelectObject(m_DC, m_Bitmap.GetHandle());
+	}
+
+	return m_DC;
 }
 
 HBITMAP CanvasD2D::GetBitmap()
@@ -219,7 +242,18 @@ HBITMAP CanvasD2D::GetBitmap()
 
 void CanvasD2D::ReleaseDC(HDC dc)
 {
-	DeleteDC(dc);
+	// The DC is kept for the next call to GetDC().
+}
+
+void CanvasD2D::DisposeDC()
+{
+	if (m_DC)
+	{
+		SelectObject(m_DC, m_OldDCBitmap);
+		DeleteDC(m_DC);
+		m_DC = nullptr;
+		m_OldDCBitmap = nullptr;
+	}
 }
 
 bool CanvasD2D::IsTransparentPixel(int x, int y)
@@ -252,6 +286,13 @@ void CanvasD2D::UpdateTargetTransform()
 		d2dMatrix._31 == 0.0f && d2dMatrix._32 == 0.0f;
 }
 
+void CanvasD2D::PushTargetClip()
+{
+	m_Target->SetTransform(D2D1::Matrix3x2F::Identity());
+	m_Target->PushAxisAlignedClip(ToRectF(m_Clip), D2D1_ANTIALIAS_MODE_ALIASED);
+	UpdateTargetTransform();
+}
+
 void CanvasD2D::SetTransform(const Gdiplus::Matrix& matrix)
 {
 	m_GdipGraphics->SetTransform(&matrix);
@@ -284,6 +325,39 @@ void CanvasD2D::RotateTransform(float angle, float x, float y, float dx, float d
 	}
 }
 
+void CanvasD2D::SetClip(const Gdiplus::Rect& rect)
+{
+	ResetClip();
+
+	// GDI+ keeps the clip in device coordinates so it does not follow later transforms.
+	Gdiplus::Matrix matrix;
+	m_GdipGraphics->GetTransform(&matrix);
+	m_GdipGraphics->ResetTransform();
+	m_GdipGraphics->SetClip(rect);
+	m_GdipGraphics->SetTransform(&matrix);
+
+	m_Clip = rect;
+	m_HasClip = true;
+
+	if (m_Target)
+	{
+		PushTargetClip();
+	}
+}
+
+void CanvasD2D::ResetClip()
+{
+	if (!m_HasClip) return;
+
+	m_GdipGraphics->ResetClip();
+	m_HasClip = false;
+
+	if (m_Target)
+	{
+		m_Target->PopAxisAlignedClip();
+	}
+}
+
 void CanvasD2D::SetAntiAliasing(bool enable)
 {
 	// TODO: Set m_Target aliasing?
@@ -63,6 +63,9 @@ public:
 	virtual void ResetTransform() override;
 	virtual void RotateTransform(float angle, float x, float y, float dx, float dy) override;
 
+	virtual void SetClip(const Gdiplus::Rect& rect) override;
+	virtual void ResetClip() override;
+
 	virtual void SetAntiAliasing(bool enable) override;
 	virtual void SetTextAntiAliasing(bool enable) override;
 
@@ -93,6 +96,11 @@ private:
 	// Sets the |m_Target| transformation to be equal to that of |m_GdipGraphics|.
 	void UpdateTargetTransform();
 
+	// Pushes |m_Clip| onto |m_Target| in untransformed coordinates.
+	void PushTargetClip();
+
+	void DisposeDC();
+
 	Microsoft::WRL::ComPtr<ID2D1RenderTarget> m_Target;
 
 	// Underlying pixel data shared by both m_Target and m_GdipBitmap.
@@ -102,11 +110,21 @@ private:
 	std::unique_ptr<Gdiplus::Graphics> m_GdipGraphics;
 	std::unique_ptr<Gdiplus::Bitmap> m_GdipBitmap;
 
+	// Memory DC with m_Bitmap selected returned by GetDC(). Kept until m_Bitmap is recreated so
+	// that a DC is not created for each present.
+	HDC m_DC;
+	HGDIOBJ m_OldDCBitmap;
+
 	bool m_TextAntiAliasing;
 
 	// |true| if PushAxisAlignedClip()/PopAxisAlignedClip() can be used.
 	bool m_CanUseAxisAlignClip;
 
+	// Set with SetClip(). Applied to |m_GdipGraphics| directly and to |m_Target| each time it is
+	// created.
+	Gdiplus::Rect m_Clip;
+	bool m_HasClip;
+
 	static UINT c_Instances;
 	static Microsoft::WRL::ComPtr<ID2D1Factory1> c_D2DFactory;
 	static Microsoft::WRL::ComPtr<IDWriteFactory1> c_DWFactory;
@@ -23,7 +23,9 @@ namespace Gfx {
 
 CanvasGDIP::CanvasGDIP() : Canvas(),
 	m_DIBSection(),
-	m_DIBSectionPixels()
+	m_DIBSectionPixels(),
+	m_DC(),
+	m_OldDCBitmap()
 {
 }
 
@@ -34,6 +36,15 @@ CanvasGDIP::~CanvasGDIP()
 
 void CanvasGDIP::Dispose()
 {
+	// The DIB section cannot be deleted while it is selected into the DC.
+	if (m_DC)
+	{
+		SelectObject(m_DC, m_OldDCBitmap);
+		DeleteDC(m_DC);
+		m_DC = nullptr;
+		m_OldDCBitmap = nullptr;
+	}
+
 	if (m_DIBSection)
 	{
 		DeleteObject(m_DIBSection);
@@ -94,9 +105,13 @@ void CanvasGDIP::EndGdiplusContext()
 
 HDC CanvasGDIP::GetDC()
 {
-	HDC dcMemory = CreateCompatibleDC(nullptr);
-	SelectObject(dcMemory, m_DIBSection);
-	return dcMemory;
+	if (!m_DC)
+	{
+		m_DC = CreateCompatibleDC(nullptr);
+		m_OldDCBitmap = SelectObject(m_DC, m_DIBSection);
+	}
+
+	return m_DC;
 }
 
 HBITMAP CanvasGDIP::GetBitmap()
@@ -107,7 +122,7 @@ HBITMAP CanvasGDIP::GetBitmap()
 
 void CanvasGDIP::ReleaseDC(HDC dc)
 {
-	DeleteDC(dc);
+	// The DC is kept for the next call to GetDC().
 }
 
 bool CanvasGDIP::IsTransparentPixel(int x, int y)
@@ -131,6 +146,21 @@ void CanvasGDIP::ResetTransform()
 	m_Graphics->ResetTransform();
 }
 
+void CanvasGDIP::SetClip(const Gdiplus::Rect& rect)
+{
+	// GDI+ keeps the clip in device coordinates so it does not follow later transforms.
+	Gdiplus::Matrix matrix;
+	m_Graphics->GetTransform(&matrix);
+	m_Graphics->ResetTransform();
+	m_Graphics->SetClip(rect);
+	m_Graphics->SetTransform(&matrix);
+}
+
+void CanvasGDIP::ResetClip()
+{
+	m_Graphics->ResetClip();
+}
+
 void CanvasGDIP::RotateTransform(float angle, float x, float y, float dx, float dy)
 {
 	m_Graphics->TranslateTransform(x, y);
@@ -154,7 +184,7 @@ void CanvasGDIP::SetTextAntiAliasing(bool enable)
 
 void CanvasGDIP::Clear(const Gdiplus::Color& color)
 {
-	if (color.GetValue() == 0x00000000)
+	if (color.GetValue() == 0x00000000 && m_Graphics->IsClipInfinite())
 	{
 		memset(m_DIBSectionPixels, 0, m_W * m_H * 4);
 	}
@@ -54,6 +54,9 @@ public:
 	virtual void ResetTransform() override;
 	virtual void RotateTransform(float angle, float x, float y, float dx, float dy) override;
 
+	virtual void SetClip(const Gdiplus::Rect& rect) override;
+	virtual void ResetClip() override;
+
 	virtual void SetAntiAliasing(bool enable) override;
 	virtual void SetTextAntiAliasing(bool enable) override;
 
@@ -83,6 +86,11 @@ private:
 	HBITMAP m_DIBSection;
 	LPDWORD m_DIBSectionPixels;
 
+	// Memory DC with m_DIBSection selected returned by GetDC(). Kept until m_DIBSection is
+	// recreated so that a DC is not created for each present.
+	HDC m_DC;
+	HGDIOBJ m_OldDCBitmap;
+
 	//static ULONG_PTR c_GdiToken;
 };
 
@@ -24,6 +24,8 @@
 namespace Gfx {
 
 TextFormatD2D::TextFormatD2D() :
+	m_LastGdiEmulation(),
+	m_MetricsGdiEmulation(),
 	m_ExtraHeight(),
 	m_LineGap(),
 	m_Trimming()
@@ -37,22 +39,32 @@ TextFormatD2D::~TextFormatD2D()
 void TextFormatD2D::Dispose()
 {
 	m_TextFormat.Reset();
-	m_TextLayout.Reset();
 	m_InlineEllipsis.Reset();
+	DisposeLayouts();
 
 	m_ExtraHeight = 0.0f;
 	m_LineGap = 0.0f;
 }
 
+void TextFormatD2D::DisposeLayouts()
+{
+	m_TextLayout.Reset();
+	m_MetricsLayout.Reset();
+	m_LastString.clear();
+	m_MetricsString.clear();
+}
+
 bool TextFormatD2D::CreateLayout(
 	const WCHAR* str, UINT strLen, float maxW, float maxH, bool gdiEmulation)
 {
 	bool strChanged = false;
 	if (strLen != m_LastString.length() ||
-		memcmp(str, m_LastString.c_str(), (strLen + 1) * sizeof(WCHAR)) != 0)
+		memcmp(str, m_LastString.c_str(), (strLen + 1) * sizeof(WCHAR)) != 0 ||
+		gdiEmulation != m_LastGdiEmulation)
 	{
 		strChanged = true;
 		m_LastString.assign(str, strLen);
+		m_LastGdiEmulation = gdiEmulation;
 	}
 
 	// The width and height of a DirectWrite layout must be non-negative.
@@ -85,7 +97,11 @@ bool TextFormatD2D::CreateLayout(
 	{
 		CanvasD2D::c_DWFactory->CreateTextLayout(
 			str, strLen, m_TextFormat.Get(), maxW, maxH, m_TextLayout.ReleaseAndGetAddressOf());
-		if (!m_TextLayout) return false;
+		if (!m_TextLayout)
+		{
+			m_LastString.clear();
+			return false;
+		}
 
 		if (gdiEmulation)
 		{
@@ -258,28 +274,55 @@ DWRITE_TEXT_METRICS TextFormatD2D::GetMetrics(
 	}
 
 	DWRITE_TEXT_METRICS metrics = {0};
-	Microsoft::WRL::ComPtr<IDWriteTextLayout> textLayout;
-	HRESULT hr = CanvasD2D::c_DWFactory->CreateTextLayout(
-		str,
-		strLen,
-		m_TextFormat.Get(),
-		maxWidth,
-		10000,
-		textLayout.GetAddressOf());
-	if (SUCCEEDED(hr))
+	HRESULT hr = S_OK;
+	const float xOffset = m_TextFormat->GetFontSize() / 6.0f;
+	if (m_MetricsLayout &&
+		strLen == m_MetricsString.length() &&
+		wmemcmp(str, m_MetricsString.c_str(), strLen) == 0 &&
+		gdiEmulation == m_MetricsGdiEmulation)
 	{
-		const float xOffset = m_TextFormat->GetFontSize() / 6.0f;
-		if (gdiEmulation)
+		if (maxWidth != m_MetricsLayout->GetMaxWidth())
 		{
-			Microsoft::WRL::ComPtr<IDWriteTextLayout1> textLayout1;
-			textLayout.As(&textLayout1);
+			m_MetricsLayout->SetMaxWidth(maxWidth);
+		}
 
-			const float emOffset = xOffset / 24.0f;
-			const DWRITE_TEXT_RANGE range = {0, strLen};
-			textLayout1->SetCharacterSpacing(emOffset, emOffset, 0.0f, range);
+		// MeasureTextLinesW() changes the word wrapping of the format between calls.
+		const DWRITE_WORD_WRAPPING wordWrapping = m_TextFormat->GetWordWrapping();
+		if (wordWrapping != m_MetricsLayout->GetWordWrapping())
+		{
+			m_MetricsLayout->SetWordWrapping(wordWrapping);
+		}
+	}
+	else
+	{
+		m_MetricsString.clear();
+		hr = CanvasD2D::c_DWFactory->CreateTextLayout(
+			str,
+			strLen,
+			m_TextFormat.Get(),
+			maxWidth,
+			10000,
+			m_MetricsLayout.ReleaseAndGetAddressOf());
+		if (SUCCEEDED(hr))
+		{
+			m_MetricsString.assign(str, strLen);
+			m_MetricsGdiEmulation = gdiEmulation;
+
+			if (gdiEmulation)
+			{
+				Microsoft::WRL::ComPtr<IDWriteTextLayout1> textLayout1;
+				m_MetricsLayout.As(&textLayout1);
+
+				const float emOffset = xOffset / 24.0f;
+				const DWRITE_TEXT_RANGE range = {0, strLen};
+				textLayout1->SetCharacterSpacing(emOffset, emOffset, 0.0f, range);
+			}
 		}
+	}
 
-		textLayout->GetMetrics(&metrics);
+	if (SUCCEEDED(hr))
+	{
+		m_MetricsLayout->GetMetrics(&metrics);
 		if (metrics.width > 0.0f)
 		{
 			if (gdiEmulation)
@@ -317,6 +360,11 @@ DWRITE_TEXT_METRICS TextFormatD2D::GetMetrics(
 
 void TextFormatD2D::SetTrimming(bool trim)
 {
+	if (trim != m_Trimming)
+	{
+		DisposeLayouts();
+	}
+
 	m_Trimming = trim;
 	IDWriteInlineObject* inlineObject = nullptr;
 	DWRITE_TRIMMING trimming = {};
@@ -340,6 +388,11 @@ void TextFormatD2D::SetTrimming(bool trim)
 
 void TextFormatD2D::SetHorizontalAlignment(HorizontalAlignment alignment)
 {
+	if (alignment != GetHorizontalAlignment())
+	{
+		DisposeLayouts();
+	}
+
 	__super::SetHorizontalAlignment(alignment);
 
 	if (m_TextFormat)
@@ -353,6 +406,11 @@ void TextFormatD2D::SetHorizontalAlignment(HorizontalAlignment alignment)
 
 void TextFormatD2D::SetVerticalAlignment(VerticalAlignment alignment)
 {
+	if (alignment != GetVerticalAlignment())
+	{
+		DisposeLayouts();
+	}
+
 	__super::SetVerticalAlignment(alignment);
 	
 	if (m_TextFormat)
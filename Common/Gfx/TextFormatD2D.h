@@ -54,19 +54,29 @@ private:
 
 	void Dispose();
 
+	// Discards the cached text layouts. Must be called whenever a property of |m_TextFormat| that
+	// is copied into the layouts changes.
+	void DisposeLayouts();
+
 	// Creates a new DirectWrite text layout if |str| has changed since last call. Since creating
 	// the layout is costly, it is more efficient to keep reusing the text layout until the text
 	// changes. Returns true if the layout is valid for use.
 	bool CreateLayout(const WCHAR* str, UINT strLen, float maxW, float maxH, bool gdiEmulation);
 
+	// Like CreateLayout(), the layout used for measuring is kept until |str| changes. Only the
+	// max width and the word wrapping are updated when measuring the same string again.
 	DWRITE_TEXT_METRICS GetMetrics(
 		const WCHAR* str, UINT strLen, bool gdiEmulation, float maxWidth = 10000.0f);
 
 	Microsoft::WRL::ComPtr<IDWriteTextFormat> m_TextFormat;
 	Microsoft::WRL::ComPtr<IDWriteTextLayout> m_TextLayout;
+	Microsoft::WRL::ComPtr<IDWriteTextLayout> m_MetricsLayout;
 	Microsoft::WRL::ComPtr<IDWriteInlineObject> m_InlineEllipsis;
 
 	std::wstring m_LastString;
+	std::wstring m_MetricsString;
+	bool m_LastGdiEmulation;
+	bool m_MetricsGdiEmulation;
 
 	// Used to emulate GDI+ behaviour.
 	float m_ExtraHeight;
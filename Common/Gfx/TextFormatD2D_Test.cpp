@@ -78,6 +78,31 @@ public:
 		metrics = textFormat->GetMetrics(L"test\r\n\r\n", 8, false);
 		Assert::AreEqual(30, (int)metrics.height);
 	}
+
+	TEST_METHOD(TestLayoutReuse)
+	{
+		std::unique_ptr<TextFormatD2D> textFormat((TextFormatD2D*)m_D2D->CreateTextFormat());
+		textFormat->SetProperties(L"Arial", 10, false, false, nullptr);
+
+		textFormat->GetMetrics(L"test", 4, false);
+		IDWriteTextLayout* metricsLayout = textFormat->m_MetricsLayout.Get();
+		textFormat->GetMetrics(L"test", 4, false, 50.0f);
+		Assert::IsTrue(metricsLayout == textFormat->m_MetricsLayout.Get());
+		textFormat->GetMetrics(L"test", 4, true);
+		Assert::IsTrue(textFormat->m_MetricsGdiEmulation);
+
+		Assert::IsTrue(textFormat->CreateLayout(L"test", 4, 50.0f, 20.0f, false));
+		IDWriteTextLayout* textLayout = textFormat->m_TextLayout.Get();
+		Assert::IsTrue(textFormat->CreateLayout(L"test", 4, 60.0f, 20.0f, false));
+		Assert::IsTrue(textLayout == textFormat->m_TextLayout.Get());
+		Assert::AreEqual(60.0f, textFormat->m_TextLayout->GetMaxWidth());
+
+		textFormat->SetTrimming(false);
+		Assert::IsTrue(textLayout == textFormat->m_TextLayout.Get());
+		textFormat->SetTrimming(true);
+		Assert::IsTrue(textFormat->m_TextLayout == nullptr);
+		Assert::IsTrue(textFormat->m_MetricsLayout == nullptr);
+	}
 };
 
 }  // namespace Gfx
@@ -0,0 +1,107 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef RM_COMMON_GRAPHUTIL_H_
+#define RM_COMMON_GRAPHUTIL_H_
+
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define RM_GRAPHUTIL_AVX
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RM_GRAPHUTIL_SSE2
+#endif
+
+// Helpers for converting graph values into pixel coordinates. Only standard C++ and compiler
+// intrinsics are used so that they can be tested and benchmarked on any platform.
+namespace GraphUtil {
+
+// Converts |value| into a coordinate between |origin| and |origin| + |range|. The value is
+// multiplied by |scale| and clamped to [0, |range|]. If |invert| is true, the result is
+// measured from |origin| + |range| towards |origin| instead.
+inline float ScaleValue(double value, double scale, float range, float origin, bool invert)
+{
+	float x = (float)(value * scale);
+	x = (x < range) ? x : range;
+	x = (x > 0.0f) ? x : 0.0f;
+	return origin + (invert ? range - x : x);
+}
+
+// Same as calling ScaleValue() on each of the |count| values. Four values are converted at a
+// time when SSE2 or AVX is enabled for the build. The results are identical to ScaleValue().
+inline void ScaleValues(
+	const double* values, size_t count, double scale, float range, float origin, bool invert,
+	float* coords)
+{
+	size_t i = 0;
+
+#if defined(RM_GRAPHUTIL_AVX)
+	{
+		const __m256d scaleV = _mm256_set1_pd(scale);
+		const __m128 rangeV = _mm_set1_ps(range);
+		const __m128 originV = _mm_set1_ps(origin);
+		const __m128 zeroV = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_loadu_pd(values + i), scaleV));
+			x = _mm_max_ps(_mm_min_ps(x, rangeV), zeroV);
+			if (invert) x = _mm_sub_ps(rangeV, x);
+			_mm_storeu_ps(coords + i, _mm_add_ps(originV, x));
+		}
+	}
+#elif defined(RM_GRAPHUTIL_SSE2)
+	{
+		const __m128d scaleV = _mm_set1_pd(scale);
+		const __m128 rangeV = _mm_set1_ps(range);
+		const __m128 originV = _mm_set1_ps(origin);
+		const __m128 zeroV = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_loadu_pd(values + i), scaleV));
+			const __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_loadu_pd(values + i + 2), scaleV));
+			__m128 x = _mm_movelh_ps(lo, hi);
+			x = _mm_max_ps(_mm_min_ps(x, rangeV), zeroV);
+			if (invert) x = _mm_sub_ps(rangeV, x);
+			_mm_storeu_ps(coords + i, _mm_add_ps(originV, x));
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		coords[i] = ScaleValue(values[i], scale, range, origin, invert);
+	}
+}
+
+// Converts the ring buffer |values| of |size| values into |size| coordinates in the order the
+// values were added, i.e. starting with the oldest value at |start|.
+inline void ScaleRingBuffer(
+	const double* values, size_t size, size_t start, double scale, float range, float origin,
+	bool invert, float* coords)
+{
+	ScaleValues(values + start, size - start, scale, range, origin, invert, coords);
+	ScaleValues(values, start, scale, range, origin, invert, coords + (size - start));
+}
+
+}  // namespace GraphUtil
+
+#endif
@@ -0,0 +1,134 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Standalone benchmark comparing GraphUtil::ScaleRingBuffer() with converting the values one at a
+// time on synthetic ring buffers. It is not part of any project and can be built on any platform,
+// for example:
+//
+//   g++ -O2 -o GraphUtil_Benchmark GraphUtil_Benchmark.cpp
+//   g++ -O2 -mavx2 -o GraphUtil_Benchmark GraphUtil_Benchmark.cpp
+//   cl /O2 /EHsc GraphUtil_Benchmark.cpp
+
+#include "GraphUtil.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// Same as the per-sample loop MeterLine::Draw() used before GraphUtil.
+void ScaleRingBufferScalar(
+	const double* values, size_t size, size_t start, double scale, float range, float origin,
+	bool invert, float* coords)
+{
+	size_t pos = start;
+	for (size_t i = 0; i < size; ++i)
+	{
+		coords[i] = GraphUtil::ScaleValue(values[pos], scale, range, origin, invert);
+		++pos;
+		pos %= size;
+	}
+}
+
+template<typename Func>
+double Measure(Func func, int iterations)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		func(i);
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+}  // namespace
+
+int main()
+{
+	const char* mode =
+#if defined(RM_GRAPHUTIL_AVX)
+		"AVX";
+#elif defined(RM_GRAPHUTIL_SSE2)
+		"SSE2";
+#else
+		"scalar";
+#endif
+	printf("GraphUtil::ScaleRingBuffer using %s\n", mode);
+	printf("%8s %6s %14s %14s %8s\n", "width", "lines", "scalar (ns)", "batched (ns)", "speedup");
+
+	const size_t widths[] = { 100, 800, 4000 };
+	const size_t lineCounts[] = { 1, 8 };
+	bool identical = true;
+	volatile float sink = 0.0f;
+
+	for (size_t width : widths)
+	{
+		for (size_t lines : lineCounts)
+		{
+			// Synthetic network-like history: noise on top of a slow wave with occasional spikes.
+			std::vector<std::vector<double>> values(lines, std::vector<double>(width));
+			unsigned int seed = 1;
+			for (size_t l = 0; l < lines; ++l)
+			{
+				for (size_t i = 0; i < width; ++i)
+				{
+					seed = seed * 1103515245 + 12345;
+					const double noise = (seed >> 16) % 1000;
+					values[l][i] = 50000.0 * (1.0 + std::sin(i * 0.05 + l)) + noise * ((i % 97 == 0) ? 100.0 : 1.0);
+				}
+			}
+
+			std::vector<float> scalar(width);
+			std::vector<float> batched(width);
+			const double scale = 99.0 / 131072.0;
+			const int iterations = (int)(20000000 / (width * lines)) + 1;
+
+			const double scalarTime = Measure([&](int i)
+			{
+				for (size_t l = 0; l < lines; ++l)
+				{
+					ScaleRingBufferScalar(values[l].data(), width, i % width, scale, 99.0f, 0.0f, true, scalar.data());
+					sink = sink + scalar[0];
+				}
+			}, iterations);
+
+			const double batchedTime = Measure([&](int i)
+			{
+				for (size_t l = 0; l < lines; ++l)
+				{
+					GraphUtil::ScaleRingBuffer(values[l].data(), width, i % width, scale, 99.0f, 0.0f, true, batched.data());
+					sink = sink + batched[0];
+				}
+			}, iterations);
+
+			for (size_t start = 0; start < width; start += 7)
+			{
+				ScaleRingBufferScalar(values[0].data(), width, start, scale, 99.0f, 5.0f, false, scalar.data());
+				GraphUtil::ScaleRingBuffer(values[0].data(), width, start, scale, 99.0f, 5.0f, false, batched.data());
+				identical = identical && scalar == batched;
+			}
+
+			printf("%8zu %6zu %14.0f %14.0f %7.2fx\n", width, lines, scalarTime, batchedTime, scalarTime / batchedTime);
+		}
+	}
+
+	printf("Results %s\n", identical ? "identical" : "DIFFER");
+	return identical ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "GraphUtil.h"
+#include "UnitTest.h"
+
+namespace GraphUtil {
+
+TEST_CLASS(Common_GraphUtil_Test)
+{
+public:
+	TEST_METHOD(TestScaleValue)
+	{
+		Assert::AreEqual(15.0f, ScaleValue(5.0, 1.0, 20.0f, 10.0f, false));
+		Assert::AreEqual(25.0f, ScaleValue(5.0, 1.0, 20.0f, 10.0f, true));
+		Assert::AreEqual(30.0f, ScaleValue(50.0, 1.0, 20.0f, 10.0f, false));
+		Assert::AreEqual(10.0f, ScaleValue(50.0, 1.0, 20.0f, 10.0f, true));
+		Assert::AreEqual(10.0f, ScaleValue(-5.0, 1.0, 20.0f, 10.0f, false));
+		Assert::AreEqual(12.5f, ScaleValue(5.0, 0.5, 20.0f, 10.0f, false));
+	}
+
+	TEST_METHOD(TestScaleRingBuffer)
+	{
+		double values[13];
+		for (size_t i = 0; i < _countof(values); ++i)
+		{
+			values[i] = (i * 37 % 11) * 0.75 - 1.0;
+		}
+
+		float coords[_countof(values)];
+		for (size_t start = 0; start < _countof(values); ++start)
+		{
+			for (int invert = 0; invert < 2; ++invert)
+			{
+				ScaleRingBuffer(values, _countof(values), start, 1.5, 9.0f, 3.0f, invert != 0, coords);
+				for (size_t i = 0; i < _countof(values); ++i)
+				{
+					const double value = values[(start + i) % _countof(values)];
+					Assert::AreEqual(ScaleValue(value, 1.5, 9.0f, 3.0f, invert != 0), coords[i]);
+				}
+			}
+		}
+	}
+};
+
+}  // namespace GraphUtil
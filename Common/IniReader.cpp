@@ -0,0 +1,255 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "StdAfx.h"
+#include "IniReader.h"
+#include <cwctype>
+#include <unordered_set>
+
+namespace IniReader {
+
+namespace {
+
+const unsigned int REPLACEMENT_CHARACTER = 0xFFFD;
+
+void AppendCodePoint(std::wstring& text, unsigned int cp)
+{
+	if (sizeof(wchar_t) == 2 && cp > 0xFFFF)
+	{
+		cp -= 0x10000;
+		text += (wchar_t)(0xD800 + (cp >> 10));
+		text += (wchar_t)(0xDC00 + (cp & 0x3FF));
+	}
+	else
+	{
+		text += (wchar_t)cp;
+	}
+}
+
+/*
+** Decodes one UTF-8 sequence at |pos| and advances |pos| past it. Returns false and advances by
+** one byte if the sequence is invalid (overlong, surrogate, out of range or truncated).
+**
+*/
+bool DecodeUTF8CodePoint(const unsigned char*& pos, const unsigned char* end, unsigned int& cp)
+{
+	const unsigned char lead = *pos++;
+	if (lead < 0x80)
+	{
+		cp = lead;
+		return true;
+	}
+
+	int length;
+	unsigned int min;
+	if ((lead & 0xE0) == 0xC0)
+	{
+		length = 1;
+		min = 0x80;
+		cp = lead & 0x1F;
+	}
+	else if ((lead & 0xF0) == 0xE0)
+	{
+		length = 2;
+		min = 0x800;
+		cp = lead & 0x0F;
+	}
+	else if ((lead & 0xF8) == 0xF0)
+	{
+		length = 3;
+		min = 0x10000;
+		cp = lead & 0x07;
+	}
+	else
+	{
+		return false;
+	}
+
+	if (end - pos < length) return false;
+
+	for (int i = 0; i < length; ++i)
+	{
+		if ((pos[i] & 0xC0) != 0x80) return false;
+		cp = (cp << 6) | (pos[i] & 0x3F);
+	}
+
+	if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return false;
+
+	pos += length;
+	return true;
+}
+
+bool IsValidUTF8(const char* data, size_t size)
+{
+	const unsigned char* pos = (const unsigned char*)data;
+	const unsigned char* end = pos + size;
+	unsigned int cp;
+	while (pos < end)
+	{
+		if (!DecodeUTF8CodePoint(pos, end, cp)) return false;
+	}
+
+	return true;
+}
+
+// Same as the white-space used by the profile API (including the DOS end-of-file character).
+bool IsSpace(wchar_t ch)
+{
+	return ch == L' ' || ch == L'\t' || ch == L'\r' || ch == L'\n' || ch == L'\v' || ch == L'\f' || ch == 0x1A;
+}
+
+}  // namespace
+
+Encoding DetectEncoding(const char* data, size_t size, size_t* bomSize)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	if (size >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE)
+	{
+		*bomSize = 2;
+		return Encoding::UTF16LE;
+	}
+
+	if (size >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF)
+	{
+		*bomSize = 3;
+		return Encoding::UTF8;
+	}
+
+	*bomSize = 0;
+	return IsValidUTF8(data, size) ? Encoding::UTF8 : Encoding::Ansi;
+}
+
+bool Decode(const char* data, size_t size, Encoding encoding, std::wstring& text)
+{
+	text.clear();
+
+	switch (encoding)
+	{
+	case Encoding::UTF8:
+		{
+			text.reserve(size);
+
+			const unsigned char* pos = (const unsigned char*)data;
+			const unsigned char* end = pos + size;
+			while (pos < end)
+			{
+				unsigned int cp;
+				AppendCodePoint(text, DecodeUTF8CodePoint(pos, end, cp) ? cp : REPLACEMENT_CHARACTER);
+			}
+		}
+		return true;
+
+	case Encoding::UTF16LE:
+		{
+			const unsigned char* bytes = (const unsigned char*)data;
+			const size_t count = size / 2;
+			text.reserve(count);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				unsigned int unit = bytes[i * 2] | (bytes[i * 2 + 1] << 8);
+				if (sizeof(wchar_t) != 2 && unit >= 0xD800 && unit <= 0xDBFF && i + 1 < count)
+				{
+					const unsigned int low = bytes[i * 2 + 2] | (bytes[i * 2 + 3] << 8);
+					if (low >= 0xDC00 && low <= 0xDFFF)
+					{
+						unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+						++i;
+					}
+				}
+
+				text += (wchar_t)unit;
+			}
+		}
+		return true;
+
+	case Encoding::Ansi:
+		break;
+	}
+
+	return false;
+}
+
+void Parse(const wchar_t* text, size_t length, std::vector<Section>& sections)
+{
+	sections.clear();
+
+	std::unordered_set<std::wstring> names;  // Upper-case
+	std::wstring upperName;
+	Section* section = nullptr;
+
+	const wchar_t* pos = text;
+	const wchar_t* const end = text + length;
+	while (pos < end)
+	{
+		const wchar_t* lineStart = pos;
+		const wchar_t* lineEnd = lineStart;
+		while (lineEnd < end && *lineEnd != L'\n') ++lineEnd;
+		pos = (lineEnd < end) ? lineEnd + 1 : end;
+
+		while (lineStart < lineEnd && IsSpace(*lineStart)) ++lineStart;
+		if (lineStart == lineEnd) continue;
+
+		if (*lineStart == L'[')
+		{
+			// The name ends at the last ']' on the line.
+			const wchar_t* nameEnd = lineEnd;
+			while (nameEnd > lineStart && *(nameEnd - 1) != L']') --nameEnd;
+			if (nameEnd > lineStart + 1)
+			{
+				const wchar_t* nameStart = lineStart + 1;
+				--nameEnd;
+
+				upperName.assign(nameStart, nameEnd);
+				for (auto& ch : upperName) ch = (wchar_t)towupper(ch);
+
+				// Only the first section with the same name is read.
+				section = nullptr;
+				if (!upperName.empty() && names.insert(upperName).second)
+				{
+					sections.emplace_back();
+					section = &sections.back();
+					section->name.assign(nameStart, nameEnd);
+				}
+				continue;
+			}
+		}
+
+		if (!section || *lineStart == L';') continue;
+
+		while (lineEnd > lineStart && IsSpace(*(lineEnd - 1))) --lineEnd;
+
+		const wchar_t* sep = lineStart;
+		while (sep < lineEnd && *sep != L'=') ++sep;
+		if (sep == lineEnd) continue;
+
+		const wchar_t* keyEnd = sep;
+		while (keyEnd > lineStart && IsSpace(*(keyEnd - 1))) --keyEnd;
+		if (keyEnd == lineStart) continue;
+
+		const wchar_t* valueStart = sep + 1;
+		while (valueStart < lineEnd && IsSpace(*valueStart)) ++valueStart;
+
+		Entry entry;
+		entry.key.assign(lineStart, keyEnd);
+		entry.value.assign(valueStart, lineEnd);
+		section->entries.push_back(std::move(entry));
+	}
+}
+
+}  // namespace IniReader
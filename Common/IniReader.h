@@ -0,0 +1,65 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef RM_COMMON_INIREADER_H_
+#define RM_COMMON_INIREADER_H_
+
+#include <string>
+#include <vector>
+
+// Single pass INI file reader following the parsing rules of the Windows profile API
+// (GetPrivateProfileSectionNames and GetPrivateProfileSection). Only standard C++ is used so
+// that it can be tested on any platform.
+namespace IniReader {
+
+enum class Encoding
+{
+	Ansi,		// Must be converted by the caller using the system code page
+	UTF8,
+	UTF16LE
+};
+
+struct Entry
+{
+	std::wstring key;
+	std::wstring value;
+};
+
+struct Section
+{
+	std::wstring name;
+	std::vector<Entry> entries;		// In file order, may contain duplicate keys
+};
+
+// Detects the encoding from the byte order mark. Files without one are read as UTF-8 if they are
+// valid UTF-8 and as ANSI otherwise. |bomSize| is set to the length of the byte order mark.
+Encoding DetectEncoding(const char* data, size_t size, size_t* bomSize);
+
+// Decodes UTF-8 or UTF-16 LE |data| (without byte order mark) into |text|. Returns false for
+// Encoding::Ansi.
+bool Decode(const char* data, size_t size, Encoding encoding, std::wstring& text);
+
+// Splits |text| into sections in file order. Like the profile API, section names are case
+// insensitive and only the first section with a given name is read, leading and trailing
+// white-space is removed from keys and values, lines starting with ';' are ignored, and lines
+// without '=' or outside of any section are skipped.
+void Parse(const wchar_t* text, size_t length, std::vector<Section>& sections);
+
+}  // namespace IniReader
+
+#endif
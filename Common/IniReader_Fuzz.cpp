@@ -0,0 +1,224 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Fuzz driver for IniReader. Arbitrary bytes are passed through DetectEncoding(), Decode() and
+// Parse() as ConfigParser::ReadIniFile() would and the results are checked against the parsing
+// rules documented in IniReader.h. It is not part of any project and can be built on any
+// platform, either with libFuzzer:
+//
+//   clang++ -g -O1 -std=c++11 -fsanitize=fuzzer,address -DRM_INIREADER_LIBFUZZER -o IniReader_Fuzz IniReader_Fuzz.cpp
+//   ./IniReader_Fuzz corpus_dir
+//
+// or as a standalone program that runs the given files or, without arguments, a fixed number of
+// randomly mutated inputs:
+//
+//   g++ -g -O1 -std=c++11 -fsanitize=address,undefined -o IniReader_Fuzz IniReader_Fuzz.cpp
+//   cl /O2 /EHsc IniReader_Fuzz.cpp
+
+// IniReader.cpp is built into this file with the include guard of StdAfx.h predefined so that the
+// Windows headers are not needed.
+#define __STDAFX_H__
+#include "IniReader.cpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+void Check(bool condition, const char* message)
+{
+	if (!condition)
+	{
+		fprintf(stderr, "IniReader_Fuzz: %s\n", message);
+		abort();
+	}
+}
+
+bool IsTrimmed(const std::wstring& str)
+{
+	return str.empty() || (!IniReader::IsSpace(str.front()) && !IniReader::IsSpace(str.back()));
+}
+
+bool EqualsNoCase(const std::wstring& str1, const std::wstring& str2)
+{
+	if (str1.length() != str2.length()) return false;
+
+	for (size_t i = 0; i < str1.length(); ++i)
+	{
+		if (towupper(str1[i]) != towupper(str2[i])) return false;
+	}
+
+	return true;
+}
+
+// Invalid UTF-8 sequences must be decoded to replacement characters.
+void CheckDecodedUTF8(const std::wstring& text)
+{
+	if (sizeof(wchar_t) != 2)
+	{
+		for (wchar_t ch : text)
+		{
+			Check((unsigned int)ch <= 0x10FFFF && ((unsigned int)ch < 0xD800 || (unsigned int)ch > 0xDFFF),
+				"Decode produced an invalid code point");
+		}
+	}
+}
+
+void CheckSections(const std::vector<IniReader::Section>& sections)
+{
+	for (size_t i = 0; i < sections.size(); ++i)
+	{
+		const IniReader::Section& section = sections[i];
+		Check(!section.name.empty(), "Empty section name");
+		Check(section.name.find(L'\n') == std::wstring::npos, "Line break in section name");
+
+		for (size_t j = 0; j < i; ++j)
+		{
+			Check(!EqualsNoCase(sections[j].name, section.name), "Duplicate section");
+		}
+
+		for (const auto& entry : section.entries)
+		{
+			Check(!entry.key.empty(), "Empty key");
+			Check(entry.key.find(L'=') == std::wstring::npos, "Separator in key");
+			Check(entry.key.find(L'\n') == std::wstring::npos, "Line break in key");
+			Check(entry.value.find(L'\n') == std::wstring::npos, "Line break in value");
+			Check(IsTrimmed(entry.key) && IsTrimmed(entry.value), "Untrimmed key or value");
+			Check(entry.key[0] != L';', "Comment read as key");
+		}
+	}
+}
+
+void ParseText(const std::wstring& text)
+{
+	std::vector<IniReader::Section> sections;
+	IniReader::Parse(text.c_str(), text.length(), sections);
+	CheckSections(sections);
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	const char* bytes = (const char*)data;
+
+	size_t bomSize;
+	const IniReader::Encoding encoding = IniReader::DetectEncoding(bytes, size, &bomSize);
+	Check(bomSize <= size, "BOM larger than input");
+
+	std::wstring text;
+	if (IniReader::Decode(bytes + bomSize, size - bomSize, encoding, text))
+	{
+		if (encoding == IniReader::Encoding::UTF8)
+		{
+			CheckDecodedUTF8(text);
+		}
+	}
+	else
+	{
+		Check(encoding == IniReader::Encoding::Ansi, "Decode failed");
+
+		// Convert like a single byte code page would.
+		text.assign((const unsigned char*)bytes, (const unsigned char*)bytes + size);
+	}
+
+	ParseText(text);
+
+	// Also decode the input with the encodings that were not detected.
+	Check(IniReader::Decode(bytes, size, IniReader::Encoding::UTF8, text), "Decode failed");
+	CheckDecodedUTF8(text);
+	ParseText(text);
+
+	Check(IniReader::Decode(bytes, size, IniReader::Encoding::UTF16LE, text), "Decode failed");
+	ParseText(text);
+
+	return 0;
+}
+
+#ifndef RM_INIREADER_LIBFUZZER
+int main(int argc, char** argv)
+{
+	if (argc > 1)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::ifstream file(argv[i], std::ios::binary);
+			const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			LLVMFuzzerTestOneInput((const uint8_t*)data.data(), data.size());
+		}
+
+		printf("%d files passed\n", argc - 1);
+		return 0;
+	}
+
+	const char* const seeds[] =
+	{
+		"[Rainmeter]\r\nUpdate=1000\r\n\r\n[Variables]\r\nColor=255,255,255\r\n",
+		"\xEF\xBB\xBF[Meter]\r\nMeter=String\r\nText=\"\xD0\xA2\xC4\x94\"\r\n; Comment\r\n",
+		"\xFF\xFE[\0A\0]\0\r\0\n\0K\0=\0V\0",
+		"  [A]  ; x\nKey = A=B \n[a]\nKey=2\n[]\n=NoKey\n[Sec]tion]\nK=\n\x1A",
+		"[A]\r\nB=\xe9t\xe9\r\n[\xF0\x9F\x98\x80]\r\nC=\xC0\x80\xED\xA0\x80\r\n",
+	};
+
+	const int iterations = 200000;
+	unsigned int seed = 1;
+	auto random = [&]()
+	{
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) & 0x7FFF;
+	};
+
+	const char tokens[] = "[]=;\"\r\n \t#\x1A\xEF\xBB\xBF\xFF\xFE\xC0\x80";
+	for (int i = 0; i < iterations; ++i)
+	{
+		const char* const seedText = seeds[i % (sizeof(seeds) / sizeof(seeds[0]))];
+		const size_t seedLength = (i % 5 == 2) ? 18 : strlen(seedText);
+		std::string data(seedText, seedLength);
+
+		// Insert, replace and delete random bytes, biased towards the characters the parser uses.
+		const int mutations = 1 + random() % 8;
+		for (int j = 0; j < mutations; ++j)
+		{
+			const size_t pos = data.empty() ? 0 : random() % (data.size() + 1);
+			const char ch = (random() % 2) ? tokens[random() % (sizeof(tokens) - 1)] : (char)random();
+			switch (random() % 3)
+			{
+			case 0:
+				data.insert(pos, 1, ch);
+				break;
+
+			case 1:
+				if (pos < data.size()) data[pos] = ch;
+				break;
+
+			case 2:
+				if (pos < data.size()) data.erase(pos, 1 + random() % 4);
+				break;
+			}
+		}
+
+		LLVMFuzzerTestOneInput((const uint8_t*)data.data(), data.size());
+	}
+
+	printf("%d inputs passed\n", iterations);
+	return 0;
+}
+#endif
@@ -0,0 +1,98 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "IniReader.h"
+#include "UnitTest.h"
+
+namespace IniReader {
+
+TEST_CLASS(Common_IniReader_Test)
+{
+public:
+	TEST_METHOD(TestDetectEncoding)
+	{
+		size_t bomSize;
+		Assert::IsTrue(DetectEncoding("\xFF\xFE[\0", 4, &bomSize) == Encoding::UTF16LE);
+		Assert::AreEqual((size_t)2, bomSize);
+		Assert::IsTrue(DetectEncoding("\xEF\xBB\xBF[A]", 6, &bomSize) == Encoding::UTF8);
+		Assert::AreEqual((size_t)3, bomSize);
+		Assert::IsTrue(DetectEncoding("[A]\r\nB=\xd0\xa2", 9, &bomSize) == Encoding::UTF8);
+		Assert::AreEqual((size_t)0, bomSize);
+		Assert::IsTrue(DetectEncoding("[A]\r\nB=\xe9t\xe9", 10, &bomSize) == Encoding::Ansi);
+		Assert::AreEqual((size_t)0, bomSize);
+	}
+
+	TEST_METHOD(TestDecode)
+	{
+		std::wstring text;
+		Assert::IsTrue(Decode("[\0A\0]\0\x22\x04", 8, Encoding::UTF16LE, text));
+		Assert::AreEqual(L"[A]\u0422", text.c_str());
+		Assert::IsTrue(Decode("[A]\xd0\xa2\xc4\x94", 7, Encoding::UTF8, text));
+		Assert::AreEqual(L"[A]\u0422\u0114", text.c_str());
+		Assert::IsTrue(Decode("A\xc0\x80", 3, Encoding::UTF8, text));
+		Assert::AreEqual(L"A\uFFFD\uFFFD", text.c_str());
+		Assert::IsFalse(Decode("A", 1, Encoding::Ansi, text));
+	}
+
+	TEST_METHOD(TestParse)
+	{
+		const std::wstring text =
+			L"Orphan=1\r\n"
+			L"[Section1]\r\n"
+			L"  Key1 = Value1  \r\n"
+			L"; Comment=1\r\n"
+			L"NoSeparator\r\n"
+			L"=NoKey\r\n"
+			L"Key2=\"Quoted\"\r\n"
+			L"key1=Duplicate\r\n"
+			L"\r\n"
+			L"  [Section2]  ; Trailing\n"
+			L"Key=A=B\n"
+			L"[SECTION1]\n"
+			L"Key3=Ignored\n"
+			L"[]\n"
+			L"Key4=Ignored\n"
+			L"[Sec]tion3]\n"
+			L"Key5=";
+
+		std::vector<Section> sections;
+		Parse(text.c_str(), text.length(), sections);
+		Assert::AreEqual((size_t)3, sections.size());
+
+		Assert::AreEqual(L"Section1", sections[0].name.c_str());
+		Assert::AreEqual((size_t)3, sections[0].entries.size());
+		Assert::AreEqual(L"Key1", sections[0].entries[0].key.c_str());
+		Assert::AreEqual(L"Value1", sections[0].entries[0].value.c_str());
+		Assert::AreEqual(L"Key2", sections[0].entries[1].key.c_str());
+		Assert::AreEqual(L"\"Quoted\"", sections[0].entries[1].value.c_str());
+		Assert::AreEqual(L"key1", sections[0].entries[2].key.c_str());
+		Assert::AreEqual(L"Duplicate", sections[0].entries[2].value.c_str());
+
+		Assert::AreEqual(L"Section2", sections[1].name.c_str());
+		Assert::AreEqual((size_t)1, sections[1].entries.size());
+		Assert::AreEqual(L"Key", sections[1].entries[0].key.c_str());
+		Assert::AreEqual(L"A=B", sections[1].entries[0].value.c_str());
+
+		Assert::AreEqual(L"Sec]tion3", sections[2].name.c_str());
+		Assert::AreEqual((size_t)1, sections[2].entries.size());
+		Assert::AreEqual(L"Key5", sections[2].entries[0].key.c_str());
+		Assert::AreEqual(L"", sections[2].entries[0].value.c_str());
+	}
+};
+
+}  // namespace IniReader
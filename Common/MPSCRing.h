@@ -0,0 +1,122 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef RM_COMMON_MPSCRING_H_
+#define RM_COMMON_MPSCRING_H_
+
+#include <atomic>
+#include <cstddef>
+
+// Fixed-capacity queue of preallocated |T| slots that any number of threads can push to without
+// locking or allocating. Only one thread at a time may pop (the caller must ensure this, e.g.
+// with a try-lock). Each slot has a sequence number telling whether it is free for the producer
+// that reserved its position or holds a published value for the consumer. |Capacity| must be a
+// power of two.
+template <typename T, size_t Capacity>
+class MPSCRing
+{
+public:
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	MPSCRing() :
+		m_Head(0),
+		m_Tail(0),
+		m_Dropped(0)
+	{
+		for (size_t i = 0; i < Capacity; ++i)
+		{
+			m_Slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MPSCRing(const MPSCRing& other) = delete;
+	MPSCRing& operator=(MPSCRing other) = delete;
+
+	// Reserves a slot and calls |fill(T&)| to write the value in place. Returns false (and counts
+	// the value as dropped) if the ring is full.
+	template <typename Fill>
+	bool Push(Fill fill)
+	{
+		size_t pos = m_Tail.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;)
+		{
+			slot = &m_Slots[pos & (Capacity - 1)];
+			const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			const ptrdiff_t diff = (ptrdiff_t)sequence - (ptrdiff_t)pos;
+			if (diff == 0)
+			{
+				if (m_Tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (diff < 0)
+			{
+				m_Dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else
+			{
+				pos = m_Tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		fill(slot->value);
+		slot->sequence.store(pos + 1);
+		return true;
+	}
+
+	// Calls |consume(T&)| for the oldest published value and frees its slot. Returns false if
+	// there is none. Values pushed after a slot that is still being filled are not popped until
+	// that slot is published.
+	template <typename Consume>
+	bool Pop(Consume consume)
+	{
+		const size_t pos = m_Head.load(std::memory_order_relaxed);
+		Slot& slot = m_Slots[pos & (Capacity - 1)];
+		if (slot.sequence.load() != pos + 1) return false;
+
+		consume(slot.value);
+		slot.sequence.store(pos + Capacity, std::memory_order_release);
+		m_Head.store(pos + 1);
+		return true;
+	}
+
+	// Returns true if Pop would return a value. Can be called by any thread, e.g. to check for
+	// values published while another thread was popping.
+	bool IsReady() const
+	{
+		const size_t pos = m_Head.load();
+		return m_Slots[pos & (Capacity - 1)].sequence.load() == pos + 1;
+	}
+
+	// Returns and resets the number of values dropped because the ring was full.
+	size_t TakeDropped() { return m_Dropped.exchange(0, std::memory_order_relaxed); }
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	Slot m_Slots[Capacity];
+	std::atomic<size_t> m_Head;		// Only changed by the consumer
+	std::atomic<size_t> m_Tail;
+	std::atomic<size_t> m_Dropped;
+};
+
+#endif
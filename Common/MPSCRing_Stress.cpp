@@ -0,0 +1,144 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Standalone stress test of MPSCRing with many producer threads and a consumer role that moves
+// between threads like in Logger::ProcessRecords(). It is not part of any project and can be
+// built on any platform, for example:
+//
+//   g++ -O2 -std=c++11 -pthread -o MPSCRing_Stress MPSCRing_Stress.cpp
+//   cl /O2 /EHsc MPSCRing_Stress.cpp
+
+#include "MPSCRing.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int PRODUCERS = 32;
+const int MESSAGES = 200000;
+
+struct Record
+{
+	int producer;
+	int sequence;
+	wchar_t message[64];	// Inline storage like Logger::Record
+};
+
+MPSCRing<Record, 256> g_Ring;
+std::mutex g_ConsumerLock;
+bool g_Processing = false;
+
+std::vector<int> g_Next(PRODUCERS, 0);	// Next expected sequence for each producer
+std::atomic<long long> g_Consumed(0);
+std::atomic<long long> g_Pushed(0);
+std::atomic<int> g_Errors(0);
+
+void Consume(Record& record)
+{
+	wchar_t expected[64];
+	swprintf(expected, 64, L"%d:%d", record.producer, record.sequence);
+	if (record.producer < 0 || record.producer >= PRODUCERS ||
+		wcscmp(record.message, expected) != 0 ||
+		record.sequence < g_Next[record.producer])
+	{
+		++g_Errors;
+		return;
+	}
+
+	// Values of a producer are popped in order, some may have been dropped in between.
+	g_Next[record.producer] = record.sequence + 1;
+	++g_Consumed;
+}
+
+// Same as Logger::ProcessRecords().
+void Process()
+{
+	do
+	{
+		if (!g_ConsumerLock.try_lock()) return;
+
+		g_Processing = true;
+		while (g_Ring.Pop(Consume))
+		{
+		}
+		g_Processing = false;
+
+		g_ConsumerLock.unlock();
+	}
+	while (g_Ring.IsReady());
+}
+
+void Produce(int producer)
+{
+	for (int i = 0; i < MESSAGES; ++i)
+	{
+		// Odd producers retry when the ring is full so that most values go through it, even
+		// producers drop them like the logger.
+		for (;;)
+		{
+			const bool pushed = g_Ring.Push([&](Record& record)
+			{
+				record.producer = producer;
+				record.sequence = i;
+				swprintf(record.message, 64, L"%d:%d", producer, i);
+			});
+
+			if (pushed) ++g_Pushed;
+			Process();
+
+			if (pushed || producer % 2 == 0) break;
+			std::this_thread::yield();
+		}
+	}
+}
+
+}  // namespace
+
+int main()
+{
+	std::vector<std::thread> threads;
+	for (int i = 0; i < PRODUCERS; ++i)
+	{
+		threads.emplace_back(Produce, i);
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	const long long dropped = (long long)g_Ring.TakeDropped();
+	const long long total = (long long)PRODUCERS * MESSAGES;
+	printf(
+		"Producers: %d, messages: %lld, consumed: %lld, dropped: %lld, errors: %d, left: %s\n",
+		PRODUCERS, total, g_Consumed.load(), dropped, g_Errors.load(), g_Ring.IsReady() ? "yes" : "no");
+
+	// Dropped values of the odd producers were retried.
+	const bool ok =
+		g_Errors == 0 &&
+		!g_Ring.IsReady() &&
+		g_Consumed == g_Pushed &&
+		g_Pushed >= total / 2 &&
+		g_Pushed <= total;
+	printf("%s\n", ok ? "PASSED" : "FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MPSCRing.h"
+#include "UnitTest.h"
+
+TEST_CLASS(Common_MPSCRing_Test)
+{
+public:
+	TEST_METHOD(TestPushPop)
+	{
+		MPSCRing<int, 4> ring;
+		Assert::IsFalse(ring.IsReady());
+		Assert::IsFalse(ring.Pop([](int&) {}));
+
+		for (int i = 0; i < 4; ++i)
+		{
+			Assert::IsTrue(ring.Push([=](int& value) { value = i; }));
+		}
+
+		// Full.
+		Assert::IsFalse(ring.Push([](int& value) { value = 4; }));
+		Assert::AreEqual((size_t)1, ring.TakeDropped());
+		Assert::AreEqual((size_t)0, ring.TakeDropped());
+
+		int popped = -1;
+		Assert::IsTrue(ring.IsReady());
+		Assert::IsTrue(ring.Pop([&](int& value) { popped = value; }));
+		Assert::AreEqual(0, popped);
+
+		// The freed slot is reused.
+		Assert::IsTrue(ring.Push([](int& value) { value = 5; }));
+
+		const int expected[] = {1, 2, 3, 5};
+		for (int i = 0; i < 4; ++i)
+		{
+			Assert::IsTrue(ring.Pop([&](int& value) { popped = value; }));
+			Assert::AreEqual(expected[i], popped);
+		}
+
+		Assert::IsFalse(ring.IsReady());
+	}
+
+	TEST_METHOD(TestPopInsidePush)
+	{
+		// A value being filled is not visible to the consumer until it is published.
+		MPSCRing<int, 4> ring;
+		ring.Push([&](int& value)
+		{
+			value = 1;
+			Assert::IsFalse(ring.IsReady());
+			Assert::IsTrue(ring.Push([](int& other) { other = 2; }));
+			Assert::IsFalse(ring.IsReady());
+		});
+
+		int popped = 0;
+		Assert::IsTrue(ring.Pop([&](int& value) { popped = value; }));
+		Assert::AreEqual(1, popped);
+		Assert::IsTrue(ring.Pop([&](int& value) { popped = value; }));
+		Assert::AreEqual(2, popped);
+	}
+};
@@ -136,6 +136,8 @@ static const int FUNC_E = 19;
 static const int FUNC_PI = 20;
 static const BYTE FUNC_INVALID = UCHAR_MAX;
 
+static const int MAX_STACK_SIZE = 64;
+
 static const Operation g_BrOp = { Operator::OpeningBracket, 0, 0};
 static const Operation g_NegOp = { Operator::SingleArgFunction, 18, 0 };
 
@@ -175,19 +177,71 @@ static CharType GetCharType(WCHAR ch);
 static BYTE GetFunctionIndex(const WCHAR* str, BYTE len);
 static Operator GetOperator(const WCHAR* str);
 
-struct Parser
+enum class Opcode : BYTE
+{
+	Number,             // Push Program::m_Numbers[arg]
+	Name,               // Push value of Program::m_Names[arg]
+	Operator,           // Apply (Operator)arg
+	SingleArgFunction,  // Apply g_Functions[funcIndex]
+	MultiArgFunction    // Apply g_Functions[funcIndex] to the top arg values
+};
+
+// Converts the infix formula into postfix instructions. The value stack is only tracked by depth
+// so that operand count errors are reported at compile time.
+struct Compiler
 {
 	Operation opStack[96];
-	double numStack[64];
 	char opTop;
 	char valTop;
 	int obrDist;
+	Program& program;
+
+	Compiler(Program& program) : opTop(0), valTop(-1), obrDist(2), program(program)
+	{
+		opStack[0].type = Operator::OpeningBracket;
+	}
 
-	Parser() : opTop(0), valTop(-1), obrDist(2) { opStack[0].type = Operator::OpeningBracket; }
+	void Emit(Opcode code, WORD arg = 0, BYTE funcIndex = 0)
+	{
+		const Program::Instruction instruction = { (BYTE)code, funcIndex, arg };
+		program.m_Code.push_back(instruction);
+	}
+
+	void EmitNumber(double num)
+	{
+		Emit(Opcode::Number, (WORD)program.m_Numbers.size());
+		program.m_Numbers.push_back(num);
+	}
+
+	void EmitName(const WCHAR* name, size_t nameLen)
+	{
+		auto& names = program.m_Names;
+		size_t index = 0;
+		while (index < names.size() &&
+			(names[index].length() != nameLen || wcsncmp(names[index].c_str(), name, nameLen) != 0))
+		{
+			++index;
+		}
+
+		if (index == names.size())
+		{
+			names.emplace_back(name, nameLen);
+		}
+
+		Emit(Opcode::Name, (WORD)index);
+	}
 };
 
-static const WCHAR* CalcToObr(Parser& parser);
-static const WCHAR* Calc(Parser& parser);
+struct Evaluator
+{
+	static const WCHAR* Run(
+		const Program& program, double* result,
+		GetValueFunc getValue, GetIndexedValueFunc getIndexedValue, void* getValueContext);
+};
+
+static const WCHAR* CalcToObr(Compiler& compiler);
+static const WCHAR* Calc(Compiler& compiler);
+static const WCHAR* Apply(Operator oper, double left, double right, double* result);
 
 struct Lexer
 {
@@ -252,52 +306,66 @@ const WCHAR* CheckedParse(const WCHAR* formula, double* result)
 const WCHAR* Parse(
 	const WCHAR* formula, double* result, GetValueFunc getValue, void* getValueContext)
 {
-	static WCHAR errorBuffer[128];
+	Program program;
+	const WCHAR* error = Compile(formula, program);
+	if (!error)
+	{
+		error = Evaluate(program, result, getValue, getValueContext);
+	}
+	return error;
+}
+
+const WCHAR* Compile(const WCHAR* formula, Program& program)
+{
+	program.Clear();
 
 	if (!*formula)
 	{
-		*result = 0.0;
 		return nullptr;
 	}
 
-	Parser parser;
+	Compiler compiler(program);
 	Lexer lexer(formula);
 
 	const WCHAR* error;
 	for (;;)
 	{
-		if ((parser.opTop == _countof(parser.opStack) - 2) ||
-			(parser.valTop == _countof(parser.numStack) - 2))
+		if ((compiler.opTop == _countof(compiler.opStack) - 2) ||
+			(compiler.valTop == MAX_STACK_SIZE - 2))
 		{
+			program.Clear();
 			return eInternal;
 		}
 
 		Token token = GetNextToken(lexer);
-		--parser.obrDist;
+		--compiler.obrDist;
 		switch (token)
 		{
 		case Token::Error:
+			program.Clear();
 			return eSyntax;
 
 		case Token::Final:
-			if ((error = CalcToObr(parser)) != nullptr)
+			if ((error = CalcToObr(compiler)) != nullptr)
 			{
+				program.Clear();
 				return error;
 			}
-			else if (parser.opTop != -1 || parser.valTop != 0)
+			else if (compiler.opTop != -1 || compiler.valTop != 0)
 			{
+				program.Clear();
 				return eInternal;
 			}
 			else
 			{
 				// Done!
-				*result = parser.numStack[0];
 				return nullptr;
 			}
 			break;
 
 		case Token::Number:
-			parser.numStack[++parser.valTop] = lexer.value.num;
+			compiler.EmitNumber(lexer.value.num);
+			++compiler.valTop;
 			break;
 
 		case Token::Operator:
@@ -305,28 +373,37 @@ const WCHAR* Parse(
 			{
 			case Operator::OpeningBracket:
 				{
-					parser.opStack[++parser.opTop] = g_BrOp;
-					parser.obrDist = 2;
+					compiler.opStack[++compiler.opTop] = g_BrOp;
+					compiler.obrDist = 2;
 				}
 				break;
 
 			case Operator::ClosingBracket:
 				{
-					if ((error = CalcToObr(parser)) != nullptr) return error;
+					if ((error = CalcToObr(compiler)) != nullptr)
+					{
+						program.Clear();
+						return error;
+					}
 				}
 				break;
 
 			case Operator::Comma:
 				{
-					if ((error = CalcToObr(parser)) != nullptr) return error;
-						
-					if (parser.opStack[parser.opTop].type == Operator::MultiArgFunction)
+					if ((error = CalcToObr(compiler)) != nullptr)
+					{
+						program.Clear();
+						return error;
+					}
+
+					if (compiler.opStack[compiler.opTop].type == Operator::MultiArgFunction)
 					{
-						parser.opStack[++parser.opTop] = g_BrOp;
-						parser.obrDist = 2;
+						compiler.opStack[++compiler.opTop] = g_BrOp;
+						compiler.obrDist = 2;
 					}
 					else
 					{
+						program.Clear();
 						return eSyntax;
 					}
 				}
@@ -339,7 +416,7 @@ const WCHAR* Parse(
 					switch (op.type)
 					{
 					case Operator::Addition:
-						if (parser.obrDist >= 1)
+						if (compiler.obrDist >= 1)
 						{
 							// Goto next token
 							continue;
@@ -347,9 +424,9 @@ const WCHAR* Parse(
 						break;
 
 					case Operator::Subtraction:
-						if (parser.obrDist >= 1)
+						if (compiler.obrDist >= 1)
 						{
-							parser.opStack[++parser.opTop] = g_NegOp;
+							compiler.opStack[++compiler.opTop] = g_NegOp;
 
 							// Goto next token
 							continue;
@@ -358,15 +435,19 @@ const WCHAR* Parse(
 
 					case Operator::Conditional:
 					case Operator::ConditionalSeparator:
-						parser.obrDist = 2;
+						compiler.obrDist = 2;
 						break;
 					}
 
-					while (g_OpPriorities[(int)op.type] <= g_OpPriorities[(int)parser.opStack[parser.opTop].type])
+					while (g_OpPriorities[(int)op.type] <= g_OpPriorities[(int)compiler.opStack[compiler.opTop].type])
 					{
-						if ((error = Calc(parser)) != nullptr) return error;
+						if ((error = Calc(compiler)) != nullptr)
+						{
+							program.Clear();
+							return error;
+						}
 					}
-					parser.opStack[++parser.opTop] = op;
+					compiler.opStack[++compiler.opTop] = op;
 				}
 				break;
 			}
@@ -381,51 +462,142 @@ const WCHAR* Parse(
 					switch (op.funcIndex)
 					{
 					case FUNC_E:
-						parser.numStack[++parser.valTop] = M_E;
+						compiler.EmitNumber(M_E);
+						++compiler.valTop;
 						break;
 
 					case FUNC_PI:
-						parser.numStack[++parser.valTop] = M_PI;
+						compiler.EmitNumber(M_PI);
+						++compiler.valTop;
 						break;
 
 					case FUNC_ROUND:
 						op.type = Operator::MultiArgFunction;
-						op.prevTop = parser.valTop;
-						parser.opStack[++parser.opTop] = op;
+						op.prevTop = compiler.valTop;
+						compiler.opStack[++compiler.opTop] = op;
 						break;
 
 					default:	// Internal function
 						op.type = Operator::SingleArgFunction;
-						parser.opStack[++parser.opTop] = op;
+						compiler.opStack[++compiler.opTop] = op;
 						break;
 					}
 				}
 				else
 				{
-					double dblval;
-					if (getValue && getValue(lexer.name, (int)lexer.nameLen, &dblval, getValueContext))
-					{
-						parser.numStack[++parser.valTop] = dblval;
-						break;
-					}
-
-					const std::wstring name(lexer.name, lexer.nameLen);
-					_snwprintf_s(errorBuffer, _TRUNCATE, eUnknFunc, name.c_str());
-					return errorBuffer;
+					// Resolved through GetValueFunc when evaluated.
+					compiler.EmitName(lexer.name, lexer.nameLen);
+					++compiler.valTop;
 				}
 				break;
 			}
 
 		default:
+			program.Clear();
 			return eSyntax;
 		}
 	}
 }
 
-static const WCHAR* Calc(Parser& parser)
+const WCHAR* Evaluate(
+	const Program& program, double* result, GetValueFunc getValue, void* getValueContext)
 {
-	double res;
-	Operation op = parser.opStack[parser.opTop--];
+	return Evaluator::Run(program, result, getValue, nullptr, getValueContext);
+}
+
+const WCHAR* EvaluateIndexed(
+	const Program& program, double* result, GetIndexedValueFunc getValue, void* getValueContext)
+{
+	return Evaluator::Run(program, result, nullptr, getValue, getValueContext);
+}
+
+const WCHAR* Evaluator::Run(
+	const Program& program, double* result,
+	GetValueFunc getValue, GetIndexedValueFunc getIndexedValue, void* getValueContext)
+{
+	static WCHAR errorBuffer[128];
+
+	if (program.m_Code.empty())
+	{
+		*result = 0.0;
+		return nullptr;
+	}
+
+	double numStack[MAX_STACK_SIZE];
+	int valTop = -1;
+
+	for (const auto& instruction : program.m_Code)
+	{
+		switch ((Opcode)instruction.code)
+		{
+		case Opcode::Number:
+			numStack[++valTop] = program.m_Numbers[instruction.arg];
+			break;
+
+		case Opcode::Name:
+			{
+				const std::wstring& name = program.m_Names[instruction.arg];
+				double dblval;
+				const bool found = getIndexedValue ?
+					getIndexedValue(instruction.arg, &dblval, getValueContext) :
+					getValue && getValue(name.c_str(), (int)name.length(), &dblval, getValueContext);
+				if (!found)
+				{
+					_snwprintf_s(errorBuffer, _TRUNCATE, eUnknFunc, name.c_str());
+					return errorBuffer;
+				}
+
+				numStack[++valTop] = dblval;
+			}
+			break;
+
+		case Opcode::SingleArgFunction:
+			numStack[valTop] = (*(SingleArgFunction)g_Functions[instruction.funcIndex].proc)(numStack[valTop]);
+			break;
+
+		case Opcode::MultiArgFunction:
+			{
+				double res;
+				valTop -= instruction.arg;
+				const WCHAR* error = (*(MultiArgFunction)g_Functions[instruction.funcIndex].proc)(instruction.arg, &numStack[valTop + 1], &res);
+				if (error) return error;
+
+				numStack[++valTop] = res;
+			}
+			break;
+
+		case Opcode::Operator:
+			{
+				const Operator oper = (Operator)instruction.arg;
+				if (oper == Operator::BitwiseNOT)
+				{
+					numStack[valTop] = (double)(~((long long)numStack[valTop]));
+				}
+				else if (oper == Operator::ConditionalSeparator)
+				{
+					const double right = numStack[valTop--];
+					const double left = numStack[valTop--];
+					numStack[valTop] = numStack[valTop] ? left : right;
+				}
+				else
+				{
+					const double right = numStack[valTop--];
+					const WCHAR* error = Apply(oper, numStack[valTop], right, &numStack[valTop]);
+					if (error) return error;
+				}
+			}
+			break;
+		}
+	}
+
+	*result = numStack[0];
+	return nullptr;
+}
+
+// Pops the top operation and emits the matching instruction.
+static const WCHAR* Calc(Compiler& compiler)
+{
+	Operation op = compiler.opStack[compiler.opTop--];
 
 	// Multi-argument function
 	if (op.type == Operator::Conditional)
@@ -434,149 +606,74 @@ static const WCHAR* Calc(Parser& parser)
 	}
 	else if (op.type == Operator::MultiArgFunction)
 	{
-		int paramcnt = parser.valTop - op.prevTop;
+		int paramcnt = compiler.valTop - op.prevTop;
 
-		parser.valTop = op.prevTop;
-		const WCHAR* error = (*(MultiArgFunction)g_Functions[op.funcIndex].proc)(paramcnt, &parser.numStack[parser.valTop + 1], &res);
-		if (error) return error;
-
-		parser.numStack[++parser.valTop] = res;
+		compiler.valTop = op.prevTop;
+		compiler.Emit(Opcode::MultiArgFunction, (WORD)paramcnt, op.funcIndex);
+		++compiler.valTop;
 		return nullptr;
 	}
-	else if (parser.valTop < 0)
+	else if (compiler.valTop < 0)
 	{
 		return eExtraOp;
 	}
 
 	// Right arg
-	double right = parser.numStack[parser.valTop--];
+	--compiler.valTop;
 
 	// One arg operations
 	if (op.type == Operator::BitwiseNOT)
 	{
-		res = (double)(~((long long)right));
+		compiler.Emit(Opcode::Operator, (WORD)op.type);
 	}
 	else if (op.type == Operator::SingleArgFunction)
 	{
-		res = (*(SingleArgFunction)g_Functions[op.funcIndex].proc)(right);
+		compiler.Emit(Opcode::SingleArgFunction, 0, op.funcIndex);
 	}
 	else
 	{
-		if (parser.valTop < 0)
+		if (compiler.valTop < 0)
 		{
 			return eExtraOp;
 		}
 
 		// Left arg
-		double left = parser.numStack[parser.valTop--];
+		--compiler.valTop;
 		switch (op.type)
 		{
 		case Operator::ShiftLeft:
-			res = (double)((long long)left << (long long)right);
-			break;
-
 		case Operator::ShiftRight:
-			res = (double)((long long)left >> (long long)right);
-			break;
-
 		case Operator::Power:
-			res = pow(left, right);
-			break;
-
 		case Operator::NotEqual:
-			res = left != right;
-			break;
-
 		case Operator::GreatorOrEqual:
-			res = left >= right;
-			break;
-
 		case Operator::LessOrEqual:
-			res = left <= right;
-			break;
-
 		case Operator::LogicalAND:
-			res = left && right;
-			break;
-
 		case Operator::LogicalOR:
-			res = left || right;
-			break;
-
 		case Operator::Addition:
-			res = left + right;
-			break;
-
 		case Operator::Subtraction:
-			res = left - right;
-			break;
-
 		case Operator::Multiplication:
-			res = left*  right;
-			break;
-
 		case Operator::Division:
-			if (right == 0.0)
-			{
-				return eInfinity;
-			}
-			else
-			{
-				res = left / right;
-			}
-			break;
-
 		case Operator::Modulo:
-			res = fmod(left, right);
-			break;
-
 		case Operator::UNK:
-			if (left <= 0)
-			{
-				res = 0.0;
-			}
-			else if (right == 0.0)
-			{
-				return eInfinity;
-			}
-			else
-			{
-				res = ceil(left / right);
-			}
-			break;
-
 		case Operator::BitwiseXOR:
-			res = (double)((long long)left ^ (long long)right);
-			break;
-
 		case Operator::BitwiseAND:
-			res = (double)((long long)left & (long long)right);
-			break;
-
 		case Operator::BitwiseOR:
-			res = (double)((long long)left | (long long)right);
-			break;
-
 		case Operator::Equal:
-			res = left == right;
-			break;
-
 		case Operator::Greater:
-			res = left > right;
-			break;
-
 		case Operator::Less:
-			res = left < right;
+			compiler.Emit(Opcode::Operator, (WORD)op.type);
 			break;
 
 		case Operator::ConditionalSeparator:
 			{
 				// Needs three arguments
-				if (parser.opTop < 0 || parser.opStack[parser.opTop--].type != Operator::Conditional)
+				if (compiler.opTop < 0 || compiler.opStack[compiler.opTop--].type != Operator::Conditional ||
+					compiler.valTop < 0)
 				{
 					return eLogicErr;
 				}
-				res = parser.numStack[parser.valTop--] ? left : right;
+				--compiler.valTop;
+				compiler.Emit(Opcode::Operator, (WORD)op.type);
 			}
 			break;
 
@@ -585,18 +682,129 @@ static const WCHAR* Calc(Parser& parser)
 		}
 	}
 
-	parser.numStack[++parser.valTop] = res;
+	++compiler.valTop;
+	return nullptr;
+}
+
+static const WCHAR* Apply(Operator oper, double left, double right, double* result)
+{
+	double res;
+	switch (oper)
+	{
+	case Operator::ShiftLeft:
+		res = (double)((long long)left << (long long)right);
+		break;
+
+	case Operator::ShiftRight:
+		res = (double)((long long)left >> (long long)right);
+		break;
+
+	case Operator::Power:
+		res = pow(left, right);
+		break;
+
+	case Operator::NotEqual:
+		res = left != right;
+		break;
+
+	case Operator::GreatorOrEqual:
+		res = left >= right;
+		break;
+
+	case Operator::LessOrEqual:
+		res = left <= right;
+		break;
+
+	case Operator::LogicalAND:
+		res = left && right;
+		break;
+
+	case Operator::LogicalOR:
+		res = left || right;
+		break;
+
+	case Operator::Addition:
+		res = left + right;
+		break;
+
+	case Operator::Subtraction:
+		res = left - right;
+		break;
+
+	case Operator::Multiplication:
+		res = left*  right;
+		break;
+
+	case Operator::Division:
+		if (right == 0.0)
+		{
+			return eInfinity;
+		}
+		else
+		{
+			res = left / right;
+		}
+		break;
+
+	case Operator::Modulo:
+		res = fmod(left, right);
+		break;
+
+	case Operator::UNK:
+		if (left <= 0)
+		{
+			res = 0.0;
+		}
+		else if (right == 0.0)
+		{
+			return eInfinity;
+		}
+		else
+		{
+			res = ceil(left / right);
+		}
+		break;
+
+	case Operator::BitwiseXOR:
+		res = (double)((long long)left ^ (long long)right);
+		break;
+
+	case Operator::BitwiseAND:
+		res = (double)((long long)left & (long long)right);
+		break;
+
+	case Operator::BitwiseOR:
+		res = (double)((long long)left | (long long)right);
+		break;
+
+	case Operator::Equal:
+		res = left == right;
+		break;
+
+	case Operator::Greater:
+		res = left > right;
+		break;
+
+	case Operator::Less:
+		res = left < right;
+		break;
+
+	default:
+		return eInternal;
+	}
+
+	*result = res;
 	return nullptr;
 }
 
-static const WCHAR* CalcToObr(Parser& parser)
+static const WCHAR* CalcToObr(Compiler& compiler)
 {
-	while (parser.opStack[parser.opTop].type != Operator::OpeningBracket)
+	while (compiler.opStack[compiler.opTop].type != Operator::OpeningBracket)
 	{
-		const WCHAR* error = Calc(parser);
+		const WCHAR* error = Calc(compiler);
 		if (error) return error;
 	}
-	--parser.opTop;
+	--compiler.opTop;
 	return nullptr;
 }
 
@@ -22,10 +22,47 @@
 #define RM_COMMON_MATHPARSER_H_
 
 #include <Windows.h>
+#include <string>
+#include <vector>
 
 namespace MathParser
 {
 	typedef bool (*GetValueFunc)(const WCHAR* str, int len, double* value, void* context);
+	typedef bool (*GetIndexedValueFunc)(size_t index, double* value, void* context);
+
+	struct Compiler;
+	struct Evaluator;
+
+	// Formula compiled into postfix form by Compile(). A program is not modified by Evaluate() and
+	// can be evaluated any number of times until the formula text changes.
+	class Program
+	{
+	public:
+		Program() {}
+
+		bool IsEmpty() const { return m_Code.empty(); }
+		void Clear() { m_Code.clear(); m_Numbers.clear(); m_Names.clear(); }
+
+		// Identifiers that are neither functions nor constants (e.g. measure names). These are
+		// resolved through the GetValueFunc passed to Evaluate().
+		size_t GetNameCount() const { return m_Names.size(); }
+		const std::wstring& GetName(size_t index) const { return m_Names[index]; }
+
+	private:
+		friend struct Compiler;
+		friend struct Evaluator;
+
+		struct Instruction
+		{
+			BYTE code;
+			BYTE funcIndex;
+			WORD arg;
+		};
+
+		std::vector<Instruction> m_Code;
+		std::vector<double> m_Numbers;
+		std::vector<std::wstring> m_Names;
+	};
 
 	const WCHAR* Check(const WCHAR* formula);
 	const WCHAR* CheckedParse(const WCHAR* formula, double* result);
@@ -33,6 +70,17 @@ namespace MathParser
 		const WCHAR* formula, double* result,
 		GetValueFunc getValue = nullptr, void* getValueContext = nullptr);
 
+	const WCHAR* Compile(const WCHAR* formula, Program& program);
+	const WCHAR* Evaluate(
+		const Program& program, double* result,
+		GetValueFunc getValue = nullptr, void* getValueContext = nullptr);
+
+	// Same as Evaluate(), but names are resolved by their index (see Program::GetName) so that
+	// callers can bind them once instead of comparing strings on every evaluation.
+	const WCHAR* EvaluateIndexed(
+		const Program& program, double* result,
+		GetIndexedValueFunc getValue, void* getValueContext);
+
 	bool IsDelimiter(WCHAR ch);
 };
 
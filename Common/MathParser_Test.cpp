@@ -94,6 +94,68 @@ public:
 		Assert::AreEqual(30.0, value);
 	}
 
+	TEST_METHOD(TestCompile)
+	{
+		Program program;
+		Assert::IsNull(Compile(L"(a + bbb) * 2 + a", program));
+		Assert::AreEqual((size_t)2, program.GetNameCount());
+		Assert::AreEqual(L"a", program.GetName(0).c_str());
+		Assert::AreEqual(L"bbb", program.GetName(1).c_str());
+
+		// The same program can be evaluated any number of times.
+		double value = 0.0;
+		Assert::IsNull(Evaluate(program, &value, GetValueHelper));
+		Assert::AreEqual(70.0, value);
+		Assert::IsNull(Evaluate(program, &value, GetValueHelper));
+		Assert::AreEqual(70.0, value);
+
+		// Names are resolved only when evaluated.
+		Assert::IsNotNull(Evaluate(program, &value));
+
+		Assert::IsNull(Compile(L"round(pi, 2) - sin(0)", program));
+		Assert::AreEqual((size_t)0, program.GetNameCount());
+		Assert::IsNull(Evaluate(program, &value));
+		Assert::AreEqual(3.14, value);
+
+		Assert::IsNull(Compile(L"", program));
+		Assert::IsTrue(program.IsEmpty());
+		Assert::IsNull(Evaluate(program, &value));
+		Assert::AreEqual(0.0, value);
+
+		Assert::IsNotNull(Compile(L"1 ? 0 ? 4 : 5 : 3", program));
+		Assert::IsTrue(program.IsEmpty());
+		Assert::IsNotNull(Compile(L"1 &&", program));
+
+		Assert::IsNull(Compile(L"1 / (a - 10)", program));
+		Assert::IsNotNull(Evaluate(program, &value, GetValueHelper));
+	}
+
+	TEST_METHOD(TestEvaluateIndexed)
+	{
+		Program program;
+		Assert::IsNull(Compile(L"x * 2 + y - x", program));
+		Assert::AreEqual((size_t)2, program.GetNameCount());
+
+		double value = 0.0;
+		Assert::IsNull(EvaluateIndexed(program, &value, GetIndexedValueHelper, nullptr));
+		Assert::AreEqual(11.0, value);
+
+		Assert::IsNull(Compile(L"x + y + z", program));
+		Assert::IsNotNull(EvaluateIndexed(program, &value, GetIndexedValueHelper, nullptr));
+	}
+
+	static bool GetIndexedValueHelper(size_t index, double* value, void* context)
+	{
+		// "x" is 10, "y" is 1, and everything else is unknown.
+		if (index < 2)
+		{
+			*value = (index == 0) ? 10.0 : 1.0;
+			return true;
+		}
+
+		return false;
+	}
+
 	static bool GetValueHelper(const WCHAR* str, int len, double* value, void* context)
 	{
 		if (wcsncmp(str, L"a", len) == 0)
@@ -0,0 +1,80 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef RM_COMMON_METRICSAMPLER_H_
+#define RM_COMMON_METRICSAMPLER_H_
+
+// Keeps the latest snapshot of a system metric source (e.g. processor times) so that all the
+// measures reading it at about the same time share a single query of the source. Each new
+// snapshot gets a new generation number so that measures computing differences between
+// snapshots can tell whether the source was sampled since they last read it. The caller owns the
+// clock and the source: pass the current time in milliseconds and a function that fills the
+// snapshot and returns false if the source could not be read.
+template <typename T>
+class MetricSampler
+{
+public:
+	explicit MetricSampler(unsigned long long maxAge) :
+		m_Snapshot(),
+		m_MaxAge(maxAge),
+		m_Time(),
+		m_Sampled(false),
+		m_Generation(),
+		m_SampleCount()
+	{
+	}
+
+	// Returns the snapshot after sampling the source with |sample| unless the snapshot was taken
+	// less than maxAge milliseconds before |now|. If the source could not be read, the previous
+	// snapshot is kept and the source is not read again until maxAge has passed.
+	template <typename Sample>
+	const T& Get(unsigned long long now, Sample sample)
+	{
+		if (!m_Sampled || now - m_Time >= m_MaxAge)
+		{
+			m_Time = now;
+			m_Sampled = true;
+			++m_SampleCount;
+
+			if (sample(m_Snapshot))
+			{
+				++m_Generation;
+			}
+		}
+
+		return m_Snapshot;
+	}
+
+	const T& GetSnapshot() const { return m_Snapshot; }
+
+	// Returns 0 until the source has been read successfully.
+	unsigned long long GetGeneration() const { return m_Generation; }
+
+	// Returns the number of times the source has been read.
+	unsigned long long GetSampleCount() const { return m_SampleCount; }
+
+private:
+	T m_Snapshot;
+	unsigned long long m_MaxAge;
+	unsigned long long m_Time;
+	bool m_Sampled;
+	unsigned long long m_Generation;
+	unsigned long long m_SampleCount;
+};
+
+#endif
@@ -0,0 +1,91 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "MetricSampler.h"
+#include "UnitTest.h"
+#include <functional>
+#include <vector>
+
+// Simulates a per-core processor time source.
+struct FakeProcessorTimes
+{
+	int calls;
+	bool fail;
+	double idle;
+
+	bool operator()(std::vector<double>& times)
+	{
+		++calls;
+		if (fail) return false;
+
+		times.assign(4, idle);
+		idle += 10.0;
+		return true;
+	}
+};
+
+TEST_CLASS(Common_MetricSampler_Test)
+{
+public:
+	TEST_METHOD(TestShared)
+	{
+		FakeProcessorTimes source = {0, false, 0.0};
+		MetricSampler<std::vector<double>> sampler(10);
+		Assert::AreEqual(0ULL, sampler.GetGeneration());
+
+		// 15 measures reading the source on the same tick share one sample.
+		for (int i = 0; i < 15; ++i)
+		{
+			const std::vector<double>& times = sampler.Get(1000, std::ref(source));
+			Assert::AreEqual((size_t)4, times.size());
+			Assert::AreEqual(0.0, times[3]);
+		}
+		Assert::AreEqual(1, source.calls);
+		Assert::AreEqual(1ULL, sampler.GetGeneration());
+
+		sampler.Get(1009, std::ref(source));
+		Assert::AreEqual(1, source.calls);
+
+		sampler.Get(1010, std::ref(source));
+		Assert::AreEqual(2, source.calls);
+		Assert::AreEqual(2ULL, sampler.GetGeneration());
+		Assert::AreEqual(10.0, sampler.GetSnapshot()[0]);
+		Assert::AreEqual(2ULL, sampler.GetSampleCount());
+	}
+
+	TEST_METHOD(TestFailure)
+	{
+		FakeProcessorTimes source = {0, false, 0.0};
+		MetricSampler<std::vector<double>> sampler(100);
+		sampler.Get(0, std::ref(source));
+
+		// The previous snapshot is kept and the source is not read again until it expires.
+		source.fail = true;
+		sampler.Get(100, std::ref(source));
+		sampler.Get(150, std::ref(source));
+		Assert::AreEqual(2, source.calls);
+		Assert::AreEqual(1ULL, sampler.GetGeneration());
+		Assert::AreEqual(0.0, sampler.GetSnapshot()[0]);
+
+		source.fail = false;
+		sampler.Get(200, std::ref(source));
+		Assert::AreEqual(3, source.calls);
+		Assert::AreEqual(2ULL, sampler.GetGeneration());
+		Assert::AreEqual(10.0, sampler.GetSnapshot()[0]);
+	}
+};
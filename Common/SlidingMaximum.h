@@ -0,0 +1,81 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef RM_COMMON_SLIDINGMAXIMUM_H_
+#define RM_COMMON_SLIDINGMAXIMUM_H_
+
+#include <cstddef>
+#include <deque>
+
+// Keeps the maximum of the last |size| values added in amortized constant time per value. The
+// values that can no longer become the maximum are dropped from a monotonic deque so that
+// graphs can autoscale without scanning their whole value history on each update.
+class SlidingMaximum
+{
+public:
+	SlidingMaximum() :
+		m_Size(),
+		m_Count()
+	{
+	}
+
+	// Removes all values and sets the number of most recent values the maximum is taken over.
+	void Reset(size_t size)
+	{
+		m_Values.clear();
+		m_Size = size;
+		m_Count = 0;
+	}
+
+	void Add(double value)
+	{
+		if (m_Size == 0) return;
+
+		while (!m_Values.empty() && m_Values.back().value <= value)
+		{
+			m_Values.pop_back();
+		}
+
+		m_Values.push_back({m_Count, value});
+		++m_Count;
+
+		while (m_Values.front().index + m_Size < m_Count)
+		{
+			m_Values.pop_front();
+		}
+	}
+
+	// Returns the maximum of the values in the window and |minimum|.
+	double Get(double minimum = 0.0) const
+	{
+		return (!m_Values.empty() && m_Values.front().value > minimum) ? m_Values.front().value : minimum;
+	}
+
+private:
+	struct Entry
+	{
+		unsigned long long index;
+		double value;
+	};
+
+	std::deque<Entry> m_Values;		// Decreasing values in the order they were added
+	size_t m_Size;
+	unsigned long long m_Count;
+};
+
+#endif
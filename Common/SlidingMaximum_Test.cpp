@@ -0,0 +1,80 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "SlidingMaximum.h"
+#include "UnitTest.h"
+
+TEST_CLASS(Common_SlidingMaximum_Test)
+{
+public:
+	TEST_METHOD(TestGet)
+	{
+		SlidingMaximum max;
+		Assert::AreEqual(0.0, max.Get());
+		max.Add(5.0);
+		Assert::AreEqual(0.0, max.Get());
+
+		max.Reset(3);
+		max.Add(-1.0);
+		Assert::AreEqual(0.0, max.Get());
+		Assert::AreEqual(-1.0, max.Get(-10.0));
+
+		max.Add(5.0);
+		max.Add(3.0);
+		Assert::AreEqual(5.0, max.Get());
+		max.Add(4.0);
+		Assert::AreEqual(5.0, max.Get());
+		max.Add(1.0);
+		Assert::AreEqual(4.0, max.Get());
+		max.Add(1.0);
+		Assert::AreEqual(4.0, max.Get());
+		max.Add(1.0);
+		Assert::AreEqual(1.0, max.Get());
+		max.Add(2.0);
+		Assert::AreEqual(2.0, max.Get());
+
+		max.Reset(3);
+		Assert::AreEqual(0.0, max.Get());
+	}
+
+	TEST_METHOD(TestMatchesScan)
+	{
+		const size_t size = 7;
+		double values[size] = {0.0};
+
+		SlidingMaximum max;
+		max.Reset(size);
+
+		unsigned int seed = 1;
+		for (size_t i = 0; i < 200; ++i)
+		{
+			seed = seed * 1103515245 + 12345;
+			const double value = (double)((seed >> 16) % 100);
+			values[i % size] = value;
+			max.Add(value);
+
+			double expected = 0.0;
+			for (size_t j = 0; j < size; ++j)
+			{
+				if (values[j] > expected) expected = values[j];
+			}
+
+			Assert::AreEqual(expected, max.Get());
+		}
+	}
+};
@@ -0,0 +1,148 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef RM_COMMON_UPDATESCHEDULER_H_
+#define RM_COMMON_UPDATESCHEDULER_H_
+
+#include <algorithm>
+#include <vector>
+
+// Schedules periodic updates of |T| clients on a common timeline. Each client is due at the
+// multiples of its interval (measured from the same origin), so clients with the same interval
+// are always due together and clients with different intervals meet on the least common
+// multiple of their intervals. The caller owns the clock: pass the current time in milliseconds
+// to Add and Collect and wake up again at GetNextTime.
+template <typename T>
+class UpdateScheduler
+{
+public:
+	// Clients due within |tolerance| milliseconds (but at most half of their interval) are
+	// collected early so that timer jitter does not cause an extra wakeup just after a tick.
+	UpdateScheduler(unsigned long long tolerance = 0) :
+		m_Tolerance(tolerance),
+		m_WakeupCount(),
+		m_WakeupStart(),
+		m_WakeupsPerSecond()
+	{
+	}
+
+	// Adds |client| or changes its interval. The first update is due at the next multiple of
+	// |interval| after |now|.
+	void Add(T* client, unsigned long long interval, unsigned long long now)
+	{
+		if (interval == 0) interval = 1;
+
+		for (auto& entry : m_Entries)
+		{
+			if (entry.client == client)
+			{
+				if (entry.interval != interval)
+				{
+					entry.interval = interval;
+					entry.next = GetNextMultiple(now, interval);
+				}
+				return;
+			}
+		}
+
+		m_Entries.push_back({client, interval, GetNextMultiple(now, interval)});
+	}
+
+	void Remove(T* client)
+	{
+		m_Entries.erase(
+			std::remove_if(m_Entries.begin(), m_Entries.end(), [&](const Entry& entry) { return entry.client == client; }),
+			m_Entries.end());
+	}
+
+	bool Contains(const T* client) const
+	{
+		return std::any_of(m_Entries.begin(), m_Entries.end(), [&](const Entry& entry) { return entry.client == client; });
+	}
+
+	bool IsEmpty() const { return m_Entries.empty(); }
+
+	// Returns the time the earliest client is due. Must not be called when empty.
+	unsigned long long GetNextTime() const
+	{
+		unsigned long long next = m_Entries.front().next - GetTolerance(m_Entries.front());
+		for (const auto& entry : m_Entries)
+		{
+			next = (std::min)(next, entry.next - GetTolerance(entry));
+		}
+		return next;
+	}
+
+	// Appends the clients due at |now| to |due| in the order they were added and schedules their
+	// next update. Ticks that were missed (e.g. while the system was busy) are skipped instead of
+	// being run in a burst.
+	void Collect(unsigned long long now, std::vector<T*>& due)
+	{
+		const size_t oldSize = due.size();
+		for (auto& entry : m_Entries)
+		{
+			if (entry.next <= now + GetTolerance(entry))
+			{
+				due.push_back(entry.client);
+				entry.next = GetNextMultiple((std::max)(now, entry.next), entry.interval);
+			}
+		}
+
+		if (due.size() != oldSize)
+		{
+			++m_WakeupCount;
+		}
+
+		if (now - m_WakeupStart >= 1000)
+		{
+			m_WakeupsPerSecond = (double)m_WakeupCount * 1000.0 / (double)(now - m_WakeupStart);
+			m_WakeupCount = 0;
+			m_WakeupStart = now;
+		}
+	}
+
+	// Returns the rate of ticks with at least one due client over the last measured second.
+	double GetWakeupsPerSecond() const { return m_WakeupsPerSecond; }
+
+private:
+	struct Entry
+	{
+		T* client;
+		unsigned long long interval;
+		unsigned long long next;
+	};
+
+	static unsigned long long GetNextMultiple(unsigned long long time, unsigned long long interval)
+	{
+		return (time / interval + 1) * interval;
+	}
+
+	unsigned long long GetTolerance(const Entry& entry) const
+	{
+		return (std::min)(m_Tolerance, entry.interval / 2);
+	}
+
+	std::vector<Entry> m_Entries;
+	unsigned long long m_Tolerance;
+
+	unsigned long long m_WakeupCount;
+	unsigned long long m_WakeupStart;
+	double m_WakeupsPerSecond;
+};
+
+#endif
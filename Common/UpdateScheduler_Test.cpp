@@ -0,0 +1,116 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "UpdateScheduler.h"
+#include "UnitTest.h"
+
+TEST_CLASS(Common_UpdateScheduler_Test)
+{
+public:
+	TEST_METHOD(TestAlignment)
+	{
+		int a = 0, b = 0, c = 0;
+		UpdateScheduler<int> scheduler;
+		Assert::IsTrue(scheduler.IsEmpty());
+
+		// Added at different times but due on the same ticks.
+		scheduler.Add(&a, 1000, 130);
+		scheduler.Add(&b, 1000, 870);
+		scheduler.Add(&c, 500, 20);
+		Assert::IsFalse(scheduler.IsEmpty());
+		Assert::AreEqual(500ULL, scheduler.GetNextTime());
+
+		std::vector<int*> due;
+		scheduler.Collect(500, due);
+		Assert::AreEqual((size_t)1, due.size());
+		Assert::IsTrue(due[0] == &c);
+
+		Assert::AreEqual(1000ULL, scheduler.GetNextTime());
+		due.clear();
+		scheduler.Collect(1000, due);
+		Assert::AreEqual((size_t)3, due.size());
+		Assert::IsTrue(due[0] == &a && due[1] == &b && due[2] == &c);
+
+		// Nothing is due between the ticks.
+		due.clear();
+		scheduler.Collect(1200, due);
+		Assert::IsTrue(due.empty());
+
+		scheduler.Remove(&c);
+		Assert::IsFalse(scheduler.Contains(&c));
+		Assert::IsTrue(scheduler.Contains(&a));
+		Assert::AreEqual(2000ULL, scheduler.GetNextTime());
+	}
+
+	TEST_METHOD(TestWakeups)
+	{
+		// 40 clients at the same interval wake up once per tick.
+		int clients[40];
+		UpdateScheduler<int> scheduler;
+		for (int i = 0; i < 40; ++i)
+		{
+			scheduler.Add(&clients[i], 1000, i * 25);
+		}
+
+		std::vector<int*> due;
+		unsigned long long now = 0;
+		for (int tick = 0; tick < 10; ++tick)
+		{
+			now = scheduler.GetNextTime();
+			due.clear();
+			scheduler.Collect(now, due);
+			Assert::AreEqual((size_t)40, due.size());
+		}
+
+		Assert::AreEqual(1.0, scheduler.GetWakeupsPerSecond());
+	}
+
+	TEST_METHOD(TestTolerance)
+	{
+		int a = 0, b = 0;
+		UpdateScheduler<int> scheduler(16);
+		scheduler.Add(&a, 1000, 0);
+		scheduler.Add(&b, 20, 0);
+		Assert::AreEqual(10ULL, scheduler.GetNextTime());
+
+		// A timer firing slightly early still collects |a|, whose next update stays on the grid.
+		std::vector<int*> due;
+		scheduler.Collect(990, due);
+		Assert::AreEqual((size_t)2, due.size());
+		due.clear();
+		scheduler.Collect(1990, due);
+		Assert::AreEqual((size_t)2, due.size());
+	}
+
+	TEST_METHOD(TestMissedTicks)
+	{
+		int a = 0;
+		UpdateScheduler<int> scheduler;
+		scheduler.Add(&a, 100, 0);
+
+		// Missed ticks are skipped.
+		std::vector<int*> due;
+		scheduler.Collect(550, due);
+		Assert::AreEqual((size_t)1, due.size());
+		Assert::AreEqual(600ULL, scheduler.GetNextTime());
+
+		// Changing the interval realigns the client.
+		scheduler.Add(&a, 250, 560);
+		Assert::AreEqual(750ULL, scheduler.GetNextTime());
+	}
+};
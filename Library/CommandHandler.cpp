@@ -19,6 +19,7 @@
 #include "StdAfx.h"
 #include "../Common/PathUtil.h"
 #include "CommandHandler.h"
+#include <algorithm>
 #include "ConfigParser.h"
 #include "Measure.h"
 #include "Logger.h"
@@ -145,6 +146,57 @@ const CustomBangInfo s_CustomBangs[] =
 	{ Bang::LsBoxHook, L"LsBoxHook", CommandHandler::DoLsBoxHookBang }
 };
 
+// All the bangs sorted by name (case-insensitive) for binary search. Bangs with the same name are
+// kept in the order of the tables above so that the first one is used.
+struct BangIndexEntry
+{
+	const WCHAR* name;
+	const BangInfo* bangInfo;
+	const CustomBangInfo* customBangInfo;
+	bool group;
+};
+
+std::vector<BangIndexEntry> CreateBangIndex()
+{
+	std::vector<BangIndexEntry> index;
+	for (const auto& bangInfo : s_Bangs)
+	{
+		BangIndexEntry entry = {bangInfo.name, &bangInfo, nullptr, false};
+		index.push_back(entry);
+	}
+
+	for (const auto& bangInfo : s_GroupBangs)
+	{
+		BangIndexEntry entry = {bangInfo.name, &bangInfo, nullptr, true};
+		index.push_back(entry);
+	}
+
+	for (const auto& bangInfo : s_CustomBangs)
+	{
+		BangIndexEntry entry = {bangInfo.name, nullptr, &bangInfo, false};
+		index.push_back(entry);
+	}
+
+	std::stable_sort(index.begin(), index.end(), [](const BangIndexEntry& a, const BangIndexEntry& b)
+	{
+		return _wcsicmp(a.name, b.name) < 0;
+	});
+	return index;
+}
+
+const std::vector<BangIndexEntry> s_BangIndex = CreateBangIndex();
+
+// Returns the index of the bang in s_BangIndex or -1 if there is no such bang.
+int FindBang(const WCHAR* name)
+{
+	auto it = std::lower_bound(s_BangIndex.begin(), s_BangIndex.end(), name, [](const BangIndexEntry& entry, const WCHAR* value)
+	{
+		return _wcsicmp(entry.name, value) < 0;
+	});
+
+	return (it != s_BangIndex.end() && _wcsicmp(it->name, name) == 0) ? (int)(it - s_BangIndex.begin()) : -1;
+}
+
 void DoBang(const BangInfo& bangInfo, std::vector<std::wstring>& args, MeterWindow* skin)
 {
 	const size_t argsCount = args.size();
@@ -226,13 +278,77 @@ void DoGroupBang(const BangInfo& bangInfo, std::vector<std::wstring>& args, Mete
 	}
 }
 
+void RunBang(const BangIndexEntry& entry, std::vector<std::wstring>& args, MeterWindow* skin)
+{
+	if (entry.customBangInfo)
+	{
+		entry.customBangInfo->handlerFunc(args, skin);
+	}
+	else if (entry.group)
+	{
+		DoGroupBang(*entry.bangInfo, args, skin);
+	}
+	else
+	{
+		DoBang(*entry.bangInfo, args, skin);
+	}
+}
+
+// Parsed actions are kept until there are this many of them (e.g. due to actions that change with
+// dynamic variables).
+const size_t MAX_PARSED_COMMANDS = 1000;
+
 }  // namespace
 
 /*
-** Parses and executes the given command.
+** Parses and executes the given command. Multi-bang actions are parsed only once and reused when
+** the same action is executed again.
 **
 */
 void CommandHandler::ExecuteCommand(const WCHAR* command, MeterWindow* skin, bool multi)
+{
+	std::shared_ptr<const ParsedCommands> commands;
+	if (multi)
+	{
+		auto it = m_ParsedCommands.find(command);
+		if (it != m_ParsedCommands.end())
+		{
+			commands = it->second;
+		}
+		else
+		{
+			auto parsed = std::make_shared<ParsedCommands>();
+			ParseCommand(command, true, *parsed);
+			commands = parsed;
+
+			if (m_ParsedCommands.size() >= MAX_PARSED_COMMANDS)
+			{
+				m_ParsedCommands.clear();
+			}
+			m_ParsedCommands.emplace(command, commands);
+		}
+	}
+	else
+	{
+		auto parsed = std::make_shared<ParsedCommands>();
+		ParseCommand(command, false, *parsed);
+		commands = parsed;
+	}
+
+	// |commands| is held here so that bangs that execute other actions (or refresh the skin) do not
+	// invalidate it.
+	for (const auto& parsedCommand : *commands)
+	{
+		ExecuteParsedCommand(parsedCommand, skin);
+	}
+}
+
+/*
+** Splits the given command into bangs and commands to run. Measures are not replaced in the
+** result.
+**
+*/
+void CommandHandler::ParseCommand(const WCHAR* command, bool multi, ParsedCommands& commands)
 {
 	if (command[0] == L'!')	// Bang
 	{
@@ -252,22 +368,23 @@ void CommandHandler::ExecuteCommand(const WCHAR* command, MeterWindow* skin, boo
 				command += 9;
 			}
 
-			std::wstring bang;
-			std::vector<std::wstring> args;
+			ParsedCommand parsedCommand;
+			parsedCommand.isBang = true;
 
 			// Find the first space
 			const WCHAR* pos = wcschr(command, L' ');
 			if (pos)
 			{
-				bang.assign(command, 0, pos - command);
-				args = ParseString(pos + 1, skin ? &skin->GetParser() : nullptr);
+				parsedCommand.text.assign(command, 0, pos - command);
+				parsedCommand.args = ParseString(pos + 1);
 			}
 			else
 			{
-				bang = command;
+				parsedCommand.text = command;
 			}
 
-			ExecuteBang(bang.c_str(), args, skin);
+			parsedCommand.bangIndex = FindBang(parsedCommand.text.c_str());
+			commands.push_back(std::move(parsedCommand));
 			return;
 		}
 	}
@@ -299,7 +416,7 @@ void CommandHandler::ExecuteCommand(const WCHAR* command, MeterWindow* skin, boo
 					// Skip whitespace
 					start = bangs.find_first_not_of(L" \t\r\n", start + 1, 4);
 
-					ExecuteCommand(bangs.c_str() + start, skin, false);
+					ParseCommand(bangs.c_str() + start, false, commands);
 				}
 			}
 			else if (bangs[i] == L'"' && isize > (i + 2) && bangs[i + 1] == L'"' && bangs[i + 2] == L'"')
@@ -316,60 +433,105 @@ void CommandHandler::ExecuteCommand(const WCHAR* command, MeterWindow* skin, boo
 	}
 	else
 	{
-		// Check for built-ins
-		if (_wcsnicmp(L"PLAY", command, 4) == 0)
+		ParsedCommand parsedCommand;
+		parsedCommand.isBang = false;
+		parsedCommand.bangIndex = -1;
+		parsedCommand.text = command;
+		commands.push_back(std::move(parsedCommand));
+	}
+}
+
+/*
+** Replaces measures in the arguments of a parsed command and executes it.
+**
+*/
+void CommandHandler::ExecuteParsedCommand(const ParsedCommand& command, MeterWindow* skin)
+{
+	if (!command.isBang)
+	{
+		ExecuteNonBangCommand(command.text.c_str(), skin);
+		return;
+	}
+
+	std::vector<std::wstring> args = command.args;
+	if (skin)
+	{
+		ConfigParser& parser = skin->GetParser();
+		for (auto& arg : args)
+		{
+			parser.ReplaceMeasures(arg);
+		}
+	}
+
+	if (command.bangIndex != -1)
+	{
+		RunBang(s_BangIndex[command.bangIndex], args, skin);
+	}
+	else
+	{
+		LogErrorF(skin, L"Invalid bang: !%s", command.text.c_str());
+	}
+}
+
+/*
+** Plays a sound for PLAY commands and runs anything else.
+**
+*/
+void CommandHandler::ExecuteNonBangCommand(const WCHAR* command, MeterWindow* skin)
+{
+	// Check for built-ins
+	if (_wcsnicmp(L"PLAY", command, 4) == 0)
+	{
+		if (command[4] == L' ' ||                      // PLAY
+			_wcsnicmp(L"LOOP ", &command[4], 5) == 0)  // PLAYLOOP
 		{
-			if (command[4] == L' ' ||                      // PLAY
-				_wcsnicmp(L"LOOP ", &command[4], 5) == 0)  // PLAYLOOP
+			command += 4;	// Skip PLAY
+
+			DWORD flags = SND_FILENAME | SND_ASYNC;
+
+			if (command[0] != L' ')
 			{
-				command += 4;	// Skip PLAY
+				flags |= SND_LOOP | SND_NODEFAULT;
+				command += 4;	// Skip LOOP
+			}
 
-				DWORD flags = SND_FILENAME | SND_ASYNC;
+			++command;	// Skip the space
+			if (command[0] != L'\0')
+			{
+				std::wstring sound = command;
 
-				if (command[0] != L' ')
+				// Strip the quotes
+				std::wstring::size_type len = sound.length();
+				if (len >= 2 && sound[0] == L'"' && sound[len - 1] == L'"')
 				{
-					flags |= SND_LOOP | SND_NODEFAULT;
-					command += 4;	// Skip LOOP
+					len -= 2;
+					sound.assign(sound, 1, len);
 				}
 
-				++command;	// Skip the space
-				if (command[0] != L'\0')
+				if (skin)
 				{
-					std::wstring sound = command;
-
-					// Strip the quotes
-					std::wstring::size_type len = sound.length();
-					if (len >= 2 && sound[0] == L'"' && sound[len - 1] == L'"')
-					{
-						len -= 2;
-						sound.assign(sound, 1, len);
-					}
-
-					if (skin)
-					{
-						skin->GetParser().ReplaceMeasures(sound);
-						skin->MakePathAbsolute(sound);
-					}
-
-					PlaySound(sound.c_str(), nullptr, flags);
+					skin->GetParser().ReplaceMeasures(sound);
+					skin->MakePathAbsolute(sound);
 				}
-				return;
-			}
-			else if (_wcsnicmp(L"STOP", &command[4], 4) == 0)  // PLAYSTOP
-			{
-				PlaySound(nullptr, nullptr, SND_PURGE);
-				return;
+
+				PlaySound(sound.c_str(), nullptr, flags);
 			}
+			return;
 		}
-
-		// Run command
-		std::wstring tmpSz = command;
-		if (skin)
+		else if (_wcsnicmp(L"STOP", &command[4], 4) == 0)  // PLAYSTOP
 		{
-			skin->GetParser().ReplaceMeasures(tmpSz);
+			PlaySound(nullptr, nullptr, SND_PURGE);
+			return;
 		}
-		RunCommand(tmpSz);
 	}
+
+	// Run command
+	std::wstring tmpSz = command;
+	if (skin)
+	{
+		skin->GetParser().ReplaceMeasures(tmpSz);
+	}
+	RunCommand(tmpSz);
 }
 
 /*
@@ -378,31 +540,11 @@ void CommandHandler::ExecuteCommand(const WCHAR* command, MeterWindow* skin, boo
 */
 void CommandHandler::ExecuteBang(const WCHAR* name, std::vector<std::wstring>& args, MeterWindow* skin)
 {
-	for (const auto& bangInfo : s_Bangs)
-	{
-		if (_wcsicmp(bangInfo.name, name) == 0)
-		{
-			DoBang(bangInfo, args, skin);
-			return;
-		}
-	}
-
-	for (const auto& bangInfo : s_GroupBangs)
-	{
-		if (_wcsicmp(bangInfo.name, name) == 0)
-		{
-			DoGroupBang(bangInfo, args, skin);
-			return;
-		}
-	}
-
-	for (const auto& bangInfo : s_CustomBangs)
+	const int index = FindBang(name);
+	if (index != -1)
 	{
-		if (_wcsicmp(bangInfo.name, name) == 0)
-		{
-			bangInfo.handlerFunc(args, skin);
-			return;
-		}
+		RunBang(s_BangIndex[index], args, skin);
+		return;
 	}
 
 	LogErrorF(skin, L"Invalid bang: !%s", name);
@@ -20,7 +20,9 @@
 #define RM_LIBRARY_COMMANDHANDLER_H_
 
 #include <Windows.h>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 class ConfigParser;
@@ -143,6 +145,26 @@ public:
 	static void DoRefreshApp(std::vector<std::wstring>& args, MeterWindow* skin);
 	static void DoQuitBang(std::vector<std::wstring>& args, MeterWindow* meterWindow);
 	static void DoLsBoxHookBang(std::vector<std::wstring>& args, MeterWindow* meterWindow);
+
+private:
+	// A bang or command split from an action. The arguments of bangs are stored without measures
+	// replaced so that the action only needs to be parsed once.
+	struct ParsedCommand
+	{
+		bool isBang;
+		int bangIndex;						// -1 if the bang does not exist
+		std::wstring text;					// Name of the bang or the command to run
+		std::vector<std::wstring> args;
+	};
+
+	typedef std::vector<ParsedCommand> ParsedCommands;
+
+	static void ParseCommand(const WCHAR* command, bool multi, ParsedCommands& commands);
+	static void ExecuteParsedCommand(const ParsedCommand& command, MeterWindow* skin);
+	static void ExecuteNonBangCommand(const WCHAR* command, MeterWindow* skin);
+
+	// Actions that have been executed (e.g. mouse and IfCondition actions) by their text.
+	std::unordered_map<std::wstring, std::shared_ptr<const ParsedCommands>> m_ParsedCommands;
 };
 
 #endif
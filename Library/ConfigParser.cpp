@@ -17,7 +17,6 @@
 */
 
 #include "StdAfx.h"
-#include "../Common/MathParser.h"
 #include "../Common/PathUtil.h"
 #include "ConfigParser.h"
 #include "Litestep.h"
@@ -30,6 +29,11 @@
 using namespace Gdiplus;
 
 std::unordered_map<std::wstring, std::wstring> ConfigParser::c_MonitorVariables;
+UINT ConfigParser::c_MonitorVariablesVersion = 0;
+std::unordered_map<std::wstring, ConfigParser::IniSectionsPtr> ConfigParser::c_PrefetchedFiles;
+
+// Formulas with dynamic variables change often, so limit the number of cached programs.
+static const size_t MAX_CACHED_FORMULAS = 512;
 
 /*
 ** The constructor
@@ -40,6 +44,9 @@ ConfigParser::ConfigParser() :
 	m_LastDefaultUsed(false),
 	m_LastValueDefined(false),
 	m_CurrentSection(),
+	m_ValuesVersion(),
+	m_VariablesVersion(),
+	m_Dependencies(),
 	m_MeterWindow()
 {
 }
@@ -59,8 +66,14 @@ void ConfigParser::Initialize(const std::wstring& filename, MeterWindow* meterWi
 	m_Measures.clear();
 	m_Sections.clear();
 	m_Values.clear();
+	m_Names.clear();
+	m_NameSlots.clear();
+	++m_ValuesVersion;
 	m_BuiltInVariables.clear();
 	m_Variables.clear();
+	++m_VariablesVersion;
+	m_Templates.clear();
+	m_Formulas.clear();
 
 	m_StyleTemplate.clear();
 	m_LastReplaced = false;
@@ -134,12 +147,22 @@ void ConfigParser::ReadVariables()
 void ConfigParser::SetVariable(std::wstring strVariable, const std::wstring& strValue)
 {
 	StrToUpperC(strVariable);
-	m_Variables[strVariable] = strValue;
+	auto result = m_Variables.emplace(strVariable, strValue);
+	if (result.second || (*result.first).second != strValue)
+	{
+		(*result.first).second = strValue;
+		++m_VariablesVersion;
+	}
 }
 
 void ConfigParser::SetBuiltInVariable(const std::wstring& strVariable, const std::wstring& strValue)
 {
-	m_BuiltInVariables[strVariable] = strValue;
+	auto result = m_BuiltInVariables.emplace(strVariable, strValue);
+	if (result.second || (*result.first).second != strValue)
+	{
+		(*result.first).second = strValue;
+		++m_VariablesVersion;
+	}
 }
 
 /*
@@ -402,6 +425,89 @@ void ConfigParser::ResetMonitorVariables(MeterWindow* meterWindow)
 	SetAutoSelectedMonitorVariables(meterWindow);
 }
 
+/*
+** Starts recording the inputs used by ReadString into |dependencies| until EndDependencies is
+** called. Option values and variables are tracked with version numbers while measure values and
+** section variables are tracked with the value that was read.
+**
+*/
+void ConfigParser::BeginDependencies(Dependencies& dependencies)
+{
+	if (c_MonitorVariables.empty())
+	{
+		SetMultiMonitorVariables(true);
+	}
+
+	dependencies.recorded = true;
+	dependencies.valuesVersion = m_ValuesVersion;
+	dependencies.variablesVersion = m_VariablesVersion;
+	dependencies.monitorVariablesVersion = c_MonitorVariablesVersion;
+	dependencies.measures.clear();
+	dependencies.sectionVariables.clear();
+	m_Dependencies = &dependencies;
+}
+
+/*
+** Returns true if any of the inputs recorded in |dependencies| has changed since.
+**
+*/
+bool ConfigParser::HaveDependenciesChanged(const Dependencies& dependencies)
+{
+	if (!dependencies.recorded ||
+		dependencies.valuesVersion != m_ValuesVersion ||
+		dependencies.variablesVersion != m_VariablesVersion ||
+		dependencies.monitorVariablesVersion != c_MonitorVariablesVersion)
+	{
+		return true;
+	}
+
+	for (const auto& dependency : dependencies.measures)
+	{
+		const WCHAR* value = dependency.first->GetStringOrFormattedValue(AUTOSCALE_OFF, 1, -1, false);
+		if (wcscmp(value, dependency.second.c_str()) != 0)
+		{
+			return true;
+		}
+	}
+
+	for (const auto& dependency : dependencies.sectionVariables)
+	{
+		std::wstring var = dependency.first;
+		std::wstring value;
+		if (!GetSectionVariable(var, value))
+		{
+			value.clear();
+		}
+
+		if (value != dependency.second)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ConfigParser::AddMeasureDependency(Measure* measure, const WCHAR* value)
+{
+	for (const auto& dependency : m_Dependencies->measures)
+	{
+		if (dependency.first == measure) return;
+	}
+
+	m_Dependencies->measures.emplace_back(measure, value);
+}
+
+void ConfigParser::AddSectionVariableDependency(const std::wstring& variable, const std::wstring& value)
+{
+	for (const auto& dependency : m_Dependencies->sectionVariables)
+	{
+		if (dependency.first == variable) return;
+	}
+
+	m_Dependencies->sectionVariables.emplace_back(variable, value);
+}
+
 /*
 ** Sets new values for the SCREENAREA/WORKAREA variables.
 **
@@ -413,6 +519,8 @@ void ConfigParser::SetMultiMonitorVariables(bool reset)
 		c_MonitorVariables[variable] = value;
 	};
 
+	++c_MonitorVariablesVersion;
+
 	if (!reset && c_MonitorVariables.empty())
 	{
 		reset = true;  // Set all variables
@@ -692,6 +800,10 @@ bool ConfigParser::ReplaceMeasures(std::wstring& result)
 				{
 					const WCHAR* value = measure->GetStringOrFormattedValue(AUTOSCALE_OFF, 1, -1, false);
 					size_t valueLen = wcslen(value);
+					if (m_Dependencies)
+					{
+						AddMeasureDependency(measure, value);
+					}
 
 					// Measure found, replace it with the value
 					result.replace(start, end - start + 1, value, valueLen);
@@ -703,6 +815,11 @@ bool ConfigParser::ReplaceMeasures(std::wstring& result)
 					std::wstring value;
 					if (GetSectionVariable(var, value))
 					{
+						if (m_Dependencies)
+						{
+							AddSectionVariableDependency(result.substr(si, end - si), value);
+						}
+
 						// Replace section variable with the value.
 						result.replace(start, end - start + 1, value);
 						start += value.length();
@@ -733,74 +850,274 @@ const std::wstring& ConfigParser::ReadString(LPCTSTR section, LPCTSTR key, LPCTS
 	m_LastDefaultUsed = false;
 	m_LastValueDefined = false;
 
-	const std::wstring strSection = section;
-	const std::wstring strKey = key;
-	const std::wstring strDefault = defValue;
+	const std::wstring* rawValue = nullptr;
+	UINT valueSectionAtom = 0;	// Section where |rawValue| was found
 
-	const std::wstring& strValue = GetValue(strSection, strKey, strDefault);
-	if (&strValue == &strDefault)
+	// A key that has never been interned cannot have a value in any section.
+	UINT keyAtom;
+	if (FindName(key, keyAtom))
 	{
-		bool foundStyleValue = false;
+		if (FindName(section, valueSectionAtom))
+		{
+			rawValue = FindValue(valueSectionAtom, keyAtom);
+		}
 
 		// If the template is defined read the value from there.
-		std::vector<std::wstring>::const_reverse_iterator iter = m_StyleTemplate.rbegin();
-		for ( ; iter != m_StyleTemplate.rend(); ++iter)
+		std::vector<UINT>::const_reverse_iterator iter = m_StyleTemplate.rbegin();
+		for ( ; !rawValue && iter != m_StyleTemplate.rend(); ++iter)
 		{
-			const std::wstring& strStyleValue = GetValue((*iter), strKey, strDefault);
+			valueSectionAtom = (*iter);
+			rawValue = FindValue(valueSectionAtom, keyAtom);
+		}
+	}
+
+	if (!rawValue)
+	{
+		result = defValue;
+		m_LastDefaultUsed = true;
+		return result;
+	}
+
+	result = *rawValue;
 
-			//LogDebugF(L"StyleTemplate: [%s] %s (from [%s]) : strDefault=%s (0x%p), strStyleValue=%s (0x%p)",
-			//	section, key, (*iter).c_str(), strDefault.c_str(), &strDefault, strStyleValue.c_str(), &strStyleValue);
+	if (!result.empty())
+	{
+		m_LastValueDefined = true;
 
-			if (&strStyleValue != &strDefault)
+		if (result.size() >= 3)
+		{
+			if (result.find(L'%') == std::wstring::npos)
 			{
-				result = strStyleValue;
-				foundStyleValue = true;
-				break;
+				// No environment variables to expand, so the value can be read through its template
+				// (which also replaces the measures).
+				ReadTemplate(GetTemplateKey(valueSectionAtom, keyAtom), *rawValue, section, bReplaceMeasures, result);
+			}
+			else
+			{
+				// Changes to the environment variables are not versioned.
+				AddUntrackedDependency();
+
+				if (result.find(L'#') != std::wstring::npos)
+				{
+					m_CurrentSection->assign(section);  // Set temporarily
+
+					if (ReplaceVariables(result))
+					{
+						m_LastReplaced = true;
+					}
+
+					m_CurrentSection->clear();  // Reset
+				}
+				else
+				{
+					PathUtil::ExpandEnvironmentVariables(result);
+				}
+
+				if (bReplaceMeasures && ReplaceMeasures(result))
+				{
+					m_LastReplaced = true;
+				}
 			}
 		}
+	}
+
+	return result;
+}
 
-		if (!foundStyleValue)
+/*
+** Same as ReplaceVariables followed by ReplaceMeasures (if bReplaceMeasures is true) on rawValue,
+** but uses the cached template of rawValue. Must not be used with values that contain
+** environment variables.
+**
+*/
+void ConfigParser::ReadTemplate(UINT64 templateKey, const std::wstring& rawValue, const WCHAR* section, bool bReplaceMeasures, std::wstring& result)
+{
+	ValueTemplate& tmpl = m_Templates[templateKey];
+	if (tmpl.raw != rawValue)
+	{
+		tmpl = ValueTemplate();
+		tmpl.raw = rawValue;
+		tmpl.sectionDependent = StrToUpper(rawValue).find(L"CURRENTSECTION") != std::wstring::npos;
+	}
+
+	if (c_MonitorVariables.empty())
+	{
+		SetMultiMonitorVariables(true);
+	}
+
+	if (tmpl.variablesVersion != m_VariablesVersion ||
+		tmpl.monitorVariablesVersion != c_MonitorVariablesVersion ||
+		(tmpl.sectionDependent && tmpl.section != section))
+	{
+		tmpl.expanded = tmpl.raw;
+		tmpl.variablesReplaced = false;
+		if (tmpl.expanded.find(L'#') != std::wstring::npos)
+		{
+			m_CurrentSection->assign(section);  // Set temporarily
+			tmpl.variablesReplaced = ReplaceVariables(tmpl.expanded);
+			m_CurrentSection->clear();  // Reset
+		}
+
+		if (tmpl.sectionDependent)
 		{
-			result = strDefault;
-			m_LastDefaultUsed = true;
-			return result;
+			tmpl.section = section;
 		}
+
+		tmpl.variablesVersion = m_VariablesVersion;
+		tmpl.monitorVariablesVersion = c_MonitorVariablesVersion;
+		tmpl.tokenized = false;
 	}
-	else
+
+	if (tmpl.variablesReplaced)
 	{
-		result = strValue;
+		m_LastReplaced = true;
 	}
 
-	if (!result.empty())
+	if (!bReplaceMeasures)
 	{
-		m_LastValueDefined = true;
+		result = tmpl.expanded;
+		return;
+	}
 
-		if (result.size() >= 3)
+	const size_t meterCount = m_MeterWindow ? m_MeterWindow->GetMeters().size() : 0;
+	if (!tmpl.tokenized || tmpl.measureCount != m_Measures.size() || tmpl.meterCount != meterCount)
+	{
+		TokenizeTemplate(tmpl);
+		tmpl.measureCount = m_Measures.size();
+		tmpl.meterCount = meterCount;
+		tmpl.tokenized = true;
+	}
+
+	if (tmpl.isLiteral)
+	{
+		result = tmpl.expanded;
+		return;
+	}
+
+	result.clear();
+	for (const auto& token : tmpl.tokens)
+	{
+		switch (token.type)
 		{
-			if (result.find(L'#') != std::wstring::npos)
-			{
-				m_CurrentSection->assign(strSection);  // Set temporarily
+		case ValueTemplate::TokenType::Literal:
+			result.append(tmpl.expanded, token.start, token.length);
+			break;
 
-				if (ReplaceVariables(result))
+		case ValueTemplate::TokenType::Measure:
+			{
+				const WCHAR* value = token.measure->GetStringOrFormattedValue(AUTOSCALE_OFF, 1, -1, false);
+				if (m_Dependencies)
 				{
-					m_LastReplaced = true;
+					AddMeasureDependency(token.measure, value);
 				}
 
-				m_CurrentSection->clear();  // Reset
+				result += value;
 			}
-			else
+			break;
+
+		case ValueTemplate::TokenType::SectionVariable:
 			{
-				PathUtil::ExpandEnvironmentVariables(result);
+				std::wstring var(tmpl.expanded, token.start, token.length);
+				std::wstring value;
+				if (!GetSectionVariable(var, value))
+				{
+					value.clear();
+				}
+
+				if (m_Dependencies)
+				{
+					AddSectionVariableDependency(tmpl.expanded.substr(token.start, token.length), value);
+				}
+
+				result += value;
 			}
+			break;
+		}
+	}
+
+	if (tmpl.hasReferences)
+	{
+		m_LastReplaced = true;
+	}
+}
 
-			if (bReplaceMeasures && ReplaceMeasures(result))
+/*
+** Splits the expanded value of the template into literal spans and references. This must match
+** the replacement rules of ReplaceMeasures.
+**
+*/
+void ConfigParser::TokenizeTemplate(ValueTemplate& tmpl)
+{
+	const std::wstring& str = tmpl.expanded;
+	tmpl.tokens.clear();
+	tmpl.isLiteral = true;
+	tmpl.hasReferences = false;
+
+	size_t literalStart = 0;
+	auto addToken = [&](ValueTemplate::TokenType type, size_t start, size_t length, Measure* measure)
+	{
+		if (length > 0 || type != ValueTemplate::TokenType::Literal)
+		{
+			ValueTemplate::Token token = { type, start, length, measure };
+			tmpl.tokens.push_back(token);
+		}
+	};
+
+	size_t start = 0;
+	while ((start = str.find(L'[', start)) != std::wstring::npos)
+	{
+		size_t si = start + 1;
+		size_t end = str.find(L']', si);
+		if (end == std::wstring::npos)
+		{
+			break;
+		}
+
+		size_t next = str.find(L'[', si);
+		if (next == std::wstring::npos || end < next)
+		{
+			size_t ei = end - 1;
+			if (si != ei && str[si] == L'*' && str[ei] == L'*')
+			{
+				// Escaped reference: drop the asterisks.
+				addToken(ValueTemplate::TokenType::Literal, literalStart, si - literalStart, nullptr);
+				addToken(ValueTemplate::TokenType::Literal, si + 1, ei - si - 1, nullptr);
+				tmpl.isLiteral = false;
+				literalStart = end;
+				start = end + 1;
+			}
+			else
 			{
-				m_LastReplaced = true;
+				std::wstring var = str.substr(si, end - si);
+
+				ValueTemplate::TokenType type = ValueTemplate::TokenType::Measure;
+				Measure* measure = GetMeasure(var);
+				if (!measure)
+				{
+					std::wstring value;
+					type = ValueTemplate::TokenType::SectionVariable;
+					if (!GetSectionVariable(var, value))
+					{
+						start = end;
+						continue;
+					}
+				}
+
+				addToken(ValueTemplate::TokenType::Literal, literalStart, start - literalStart, nullptr);
+				addToken(type, si, end - si, measure);
+				tmpl.isLiteral = false;
+				tmpl.hasReferences = true;
+				literalStart = end + 1;
+				start = end + 1;
 			}
 		}
+		else
+		{
+			start = next;
+		}
 	}
 
-	return result;
+	addToken(ValueTemplate::TokenType::Literal, literalStart, str.length() - literalStart, nullptr);
 }
 
 bool ConfigParser::IsKeyDefined(LPCTSTR section, LPCTSTR key)
@@ -870,7 +1187,7 @@ int ConfigParser::ReadInt(LPCTSTR section, LPCTSTR key, int defValue)
 		if (*string == L'(')
 		{
 			double dblValue;
-			const WCHAR* errMsg = MathParser::CheckedParse(string, &dblValue);
+			const WCHAR* errMsg = CheckedParseFormula(string, &dblValue);
 			if (!errMsg)
 			{
 				return (int)dblValue;
@@ -902,7 +1219,7 @@ uint32_t ConfigParser::ReadUInt(LPCTSTR section, LPCTSTR key, uint32_t defValue)
 		if (*string == L'(')
 		{
 			double dblValue;
-			const WCHAR* errMsg = MathParser::CheckedParse(string, &dblValue);
+			const WCHAR* errMsg = CheckedParseFormula(string, &dblValue);
 			if (!errMsg)
 			{
 				return (uint32_t)dblValue;
@@ -934,7 +1251,7 @@ uint64_t ConfigParser::ReadUInt64(LPCTSTR section, LPCTSTR key, uint64_t defValu
 		if (*string == L'(')
 		{
 			double dblValue;
-			const WCHAR* errMsg = MathParser::CheckedParse(string, &dblValue);
+			const WCHAR* errMsg = CheckedParseFormula(string, &dblValue);
 			if (!errMsg)
 			{
 				return (uint64_t)dblValue;
@@ -966,7 +1283,7 @@ double ConfigParser::ReadFloat(LPCTSTR section, LPCTSTR key, double defValue)
 		const WCHAR* string = result.c_str();
 		if (*string == L'(')
 		{
-			const WCHAR* errMsg = MathParser::CheckedParse(string, &value);
+			const WCHAR* errMsg = CheckedParseFormula(string, &value);
 			if (!errMsg)
 			{
 				return value;
@@ -995,7 +1312,7 @@ bool ConfigParser::ParseFormula(const std::wstring& formula, double* resultValue
 	if (!formula.empty() && formula[0] == L'(' && formula[formula.size() - 1] == L')')
 	{
 		const WCHAR* string = formula.c_str();
-		const WCHAR* errMsg = MathParser::CheckedParse(string, resultValue);
+		const WCHAR* errMsg = CheckedParseFormula(string, resultValue);
 		if (errMsg != nullptr)
 		{
 			LogErrorF(m_MeterWindow, L"Formula: %s: %s", errMsg, string);
@@ -1077,6 +1394,39 @@ std::vector<std::wstring> ConfigParser::Tokenize(const std::wstring& str, const
 	return tokens;
 }
 
+/*
+** Same as MathParser::CheckedParse, but the compiled formula is cached so that repeated reads of
+** the same formula (e.g. with DynamicVariables=1) only need to evaluate it.
+**
+*/
+const WCHAR* ConfigParser::CheckedParseFormula(const WCHAR* formula, double* result)
+{
+	auto iter = m_Formulas.find(formula);
+	if (iter == m_Formulas.end())
+	{
+		MathParser::Program program;
+		const WCHAR* errMsg = MathParser::Check(formula);
+		if (!errMsg)
+		{
+			errMsg = MathParser::Compile(formula, program);
+		}
+
+		if (errMsg)
+		{
+			return errMsg;
+		}
+
+		if (m_Formulas.size() >= MAX_CACHED_FORMULAS)
+		{
+			m_Formulas.clear();
+		}
+
+		iter = m_Formulas.emplace(formula, std::move(program)).first;
+	}
+
+	return MathParser::Evaluate(iter->second, result);
+}
+
 /*
 ** Helper method that parses the floating-point value from the given string.
 ** If the given string is invalid format or causes overflow/underflow, returns given default value.
@@ -1325,77 +1675,41 @@ void ConfigParser::ReadIniFile(const std::wstring& iniFile, LPCTSTR skinSection,
 		return;
 	}
 
-	// Avoid "IniFileMapping"
-	std::wstring iniRead = System::GetTemporaryFile(iniFile);
-	bool temporary = (!iniRead.empty() && (iniRead.size() != 1 || iniRead[0] != L'?'));
+	if (GetRainmeter().GetDebug()) LogDebugF(m_MeterWindow, L"Reading file: %s", iniFile.c_str());
 
-	if (temporary)
+	// The file is parsed in a single pass instead of through the profile API, which reparses the
+	// file for every section (and would require a temporary copy to avoid "IniFileMapping").
+	IniSectionsPtr fileSections;
+	if (!c_PrefetchedFiles.empty())
 	{
-		if (GetRainmeter().GetDebug()) LogDebugF(m_MeterWindow, L"Reading file: %s (Temp: %s)", iniFile.c_str(), iniRead.c_str());
+		auto iter = c_PrefetchedFiles.find(GetPrefetchKey(iniFile));
+		if (iter != c_PrefetchedFiles.end())
+		{
+			fileSections = (*iter).second;
+		}
 	}
-	else
+
+	if (!fileSections)
 	{
-		if (GetRainmeter().GetDebug()) LogDebugF(m_MeterWindow, L"Reading file: %s", iniFile.c_str());
-		iniRead = iniFile;
+		auto readSections = std::make_shared<std::vector<IniReader::Section>>();
+		if (!ReadIniSections(iniFile, *readSections)) return;
+		fileSections = readSections;
 	}
 
 	// Get all the sections (i.e. different meters)
-	std::list<std::wstring> sections;
+	std::vector<const IniReader::Section*> sections;
 	std::unordered_set<std::wstring> unique;
 	std::wstring key, value;  // buffer
 
-	DWORD itemsSize = MAX_LINE_LENGTH;
-	WCHAR* items = new WCHAR[itemsSize];
-	WCHAR* pos = nullptr;
-	WCHAR* epos = nullptr;
-
 	if (skinSection == nullptr)
 	{
-		// Get all the sections
-		do
+		for (const auto& section : *fileSections)
 		{
-			items[0] = 0;
-			DWORD res = GetPrivateProfileSectionNames(items, itemsSize, iniRead.c_str());
-			if (res == 0)		// File not found
-			{
-				delete [] items;
-				if (temporary) System::RemoveFile(iniRead);
-				return;
-			}
-			if (res < itemsSize - 2)		// Fits in the buffer
+			if (m_FoundSections.insert(StrToUpper(section.name)).second)
 			{
-				epos = items + res;
-				break;
-			}
-
-			delete [] items;
-			itemsSize *= 2;
-			items = new WCHAR[itemsSize];
-		}
-		while (true);
-
-		// Read the sections
-		pos = items;
-		while (pos < epos)
-		{
-			if (*pos)
-			{
-				value = pos;  // section name
-				StrToUpperC(key.assign(value));
-				if (unique.insert(key).second)
-				{
-					if (m_FoundSections.insert(key).second)
-					{
-						m_Sections.insert(m_SectionInsertPos, value);
-					}
-					sections.push_back(value);
-				}
-				pos += value.size() + 1;
-			}
-			else  // Empty string
-			{
-				++pos;
+				m_Sections.insert(m_SectionInsertPos, section.name);
 			}
+			sections.push_back(&section);
 		}
 	}
 	else
@@ -1404,8 +1718,14 @@ void ConfigParser::ReadIniFile(const std::wstring& iniFile, LPCTSTR skinSection,
 		const std::wstring strRainmeter = L"Rainmeter";
 		const std::wstring strFolder = skinSection;
 
-		sections.push_back(strRainmeter);
-		sections.push_back(strFolder);
+		for (const auto& section : *fileSections)
+		{
+			if (_wcsicmp(section.name.c_str(), strRainmeter.c_str()) == 0 ||
+				_wcsicmp(section.name.c_str(), strFolder.c_str()) == 0)
+			{
+				sections.push_back(&section);
+			}
+		}
 
 		if (depth == 0)  // Add once
 		{
@@ -1419,118 +1739,222 @@ void ConfigParser::ReadIniFile(const std::wstring& iniFile, LPCTSTR skinSection,
 	{
 		unique.clear();
 
-		const WCHAR* sectionName = (*it).c_str();
+		const std::wstring& section = (*it)->name;
+		const WCHAR* sectionName = section.c_str();
 		bool isVariables = (_wcsicmp(sectionName, L"Variables") == 0);
 		bool isMetadata = (skinSection == nullptr && !isVariables && _wcsicmp(sectionName, L"Metadata") == 0);
 		bool resetInsertPos = true;
 
-		// Read all "key=value" from the section
-		do
+		for (const auto& entry : (*it)->entries)
 		{
-			items[0] = 0;
-			DWORD res = GetPrivateProfileSection(sectionName, items, itemsSize, iniRead.c_str());
-			if (res < itemsSize - 2)		// Fits in the buffer
+			StrToUpperC(key.assign(entry.key));
+			if (!unique.insert(key).second) continue;
+
+			const WCHAR* sep = entry.value.c_str();
+			size_t clen = entry.value.length();  // value's length
+
+			// Trim surrounded quotes from value
+			if (clen >= 2 && (sep[0] == L'"' || sep[0] == L'\'') && sep[clen - 1] == sep[0])
 			{
-				epos = items + res;
-				break;
+				clen -= 2;
+				++sep;
 			}
 
-			delete [] items;
-			itemsSize *= 2;
-			items = new WCHAR[itemsSize];
-		}
-		while (true);
-
-		pos = items;
-		while (pos < epos)
-		{
-			if (*pos)
+			if (wcsncmp(key.c_str(), L"@INCLUDE", 8) == 0)
 			{
-				size_t len = wcslen(pos);
-				WCHAR* sep = wmemchr(pos, L'=', len);
-				if (sep != nullptr && sep != pos)
+				if (clen > 0)
 				{
-					size_t clen = sep - pos;  // key's length
-
-					StrToUpperC(key.assign(pos, clen));
-					if (unique.insert(key).second)
+					value.assign(sep, clen);
+					ReadVariables();
+					ReplaceVariables(value);
+					if (!PathUtil::IsAbsolute(value))
 					{
-						++sep;
-						clen = len - (clen + 1);  // value's length
-
-						// Trim surrounded quotes from value
-						if (clen >= 2 && (sep[0] == L'"' || sep[0] == L'\'') && sep[clen - 1] == sep[0])
-						{
-							clen -= 2;
-							++sep;
-						}
+						// Relative to the ini folder
+						value.insert(0, PathUtil::GetFolderFromFilePath(iniFile));
+					}
 
-						if (wcsncmp(key.c_str(), L"@INCLUDE", 8) == 0)
+					if (resetInsertPos)
+					{
+						auto jt = it;
+						if (++jt == sections.cend())  // Special case: @include was used in the last section of the current file
 						{
-							if (clen > 0)
-							{
-								value.assign(sep, clen);
-								ReadVariables();
-								ReplaceVariables(value);
-								if (!PathUtil::IsAbsolute(value))
-								{
-									// Relative to the ini folder
-									value.insert(0, PathUtil::GetFolderFromFilePath(iniFile));
-								}
-
-								if (resetInsertPos)
-								{
-									auto jt = it;
-									if (++jt == sections.end())  // Special case: @include was used in the last section of the current file
-									{
-										// Set the insertion place to the last
-										m_SectionInsertPos = m_Sections.end();
-										resetInsertPos = false;
-									}
-									else
-									{
-										// Find the appropriate insertion place
-										for (jt = m_Sections.cbegin(); jt != m_Sections.cend(); ++jt)
-										{
-											if (_wcsicmp((*jt).c_str(), sectionName) == 0)
-											{
-												m_SectionInsertPos = ++jt;
-												resetInsertPos = false;
-												break;
-											}
-										}
-									}
-								}
-
-								ReadIniFile(value, skinSection, depth + 1);
-							}
+							// Set the insertion place to the last
+							m_SectionInsertPos = m_Sections.end();
+							resetInsertPos = false;
 						}
 						else
 						{
-							if (!isMetadata)  // Uncache Metadata's key-value pair in the skin
+							// Find the appropriate insertion place
+							for (auto kt = m_Sections.cbegin(); kt != m_Sections.cend(); ++kt)
 							{
-								value.assign(sep, clen);
-								SetValue((*it), key, value);
-
-								if (isVariables)
+								if (_wcsicmp((*kt).c_str(), sectionName) == 0)
 								{
-									m_ListVariables.push_back(key);
+									m_SectionInsertPos = ++kt;
+									resetInsertPos = false;
+									break;
 								}
 							}
 						}
 					}
+
+					ReadIniFile(value, skinSection, depth + 1);
 				}
-				pos += len + 1;
 			}
-			else  // Empty string
+			else
 			{
-				++pos;
+				if (!isMetadata)  // Uncache Metadata's key-value pair in the skin
+				{
+					value.assign(sep, clen);
+					SetValue(section, key, value);
+
+					if (isVariables)
+					{
+						m_ListVariables.push_back(key);
+					}
+				}
 			}
 		}
 	}
+}
+
+/*
+** Maps the ini file into memory, decodes it (UTF-16 LE, UTF-8 or ANSI), and splits it into
+** sections. Returns false if the file could not be read.
+**
+*/
+bool ConfigParser::ReadIniSections(const std::wstring& iniFile, std::vector<IniReader::Section>& sections)
+{
+	HANDLE file = CreateFile(iniFile.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 || fileSize.HighPart != 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping) return false;
+
+	const char* data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data) return false;
 
-	delete [] items;
-	if (temporary) System::RemoveFile(iniRead);
+	const size_t size = (size_t)fileSize.QuadPart;
+	size_t bomSize;
+	const IniReader::Encoding encoding = IniReader::DetectEncoding(data, size, &bomSize);
+
+	std::wstring text;
+	if (!IniReader::Decode(data + bomSize, size - bomSize, encoding, text))
+	{
+		text = StringUtil::Widen(data + bomSize, (int)(size - bomSize));
+	}
+
+	UnmapViewOfFile(data);
+
+	IniReader::Parse(text.c_str(), text.length(), sections);
+	return true;
+}
+
+/*
+** Reads and parses the given skin files, and the files they @Include without using variables, on
+** the system thread pool. ReadIniFile uses the parsed files instead of reading them again until
+** ClearPrefetchedIniFiles is called. Returns when all the files have been parsed.
+**
+*/
+void ConfigParser::PrefetchIniFiles(const std::vector<std::wstring>& iniFiles)
+{
+	if (iniFiles.empty()) return;
+
+	PrefetchContext context;
+	System::InitializeCriticalSection(&context.lock);
+	context.pending = (LONG)iniFiles.size();
+	context.doneEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+	for (const auto& iniFile : iniFiles)
+	{
+		PrefetchItem* item = new PrefetchItem;
+		item->context = &context;
+		item->iniFile = iniFile;
+		if (!QueueUserWorkItem(PrefetchThreadProc, item, WT_EXECUTEDEFAULT))
+		{
+			PrefetchThreadProc(item);
+		}
+	}
+
+	WaitForSingleObject(context.doneEvent, INFINITE);
+	CloseHandle(context.doneEvent);
+	DeleteCriticalSection(&context.lock);
+}
+
+DWORD WINAPI ConfigParser::PrefetchThreadProc(void* param)
+{
+	PrefetchItem* item = (PrefetchItem*)param;
+	PrefetchContext* context = item->context;
+	PrefetchIniFile(*context, item->iniFile, 0);
+	delete item;
+
+	if (InterlockedDecrement(&context->pending) == 0)
+	{
+		SetEvent(context->doneEvent);
+	}
+
+	return 0;
+}
+
+void ConfigParser::PrefetchIniFile(PrefetchContext& context, const std::wstring& iniFile, int depth)
+{
+	if (depth > 100) return;
+
+	const std::wstring key = GetPrefetchKey(iniFile);
+
+	// Files included by several skins are parsed only once.
+	EnterCriticalSection(&context.lock);
+	const bool isNew = c_PrefetchedFiles.insert(std::make_pair(key, IniSectionsPtr())).second;
+	LeaveCriticalSection(&context.lock);
+	if (!isNew) return;
+
+	auto sections = std::make_shared<std::vector<IniReader::Section>>();
+	if (!ReadIniSections(iniFile, *sections)) return;
+
+	EnterCriticalSection(&context.lock);
+	c_PrefetchedFiles[key] = sections;
+	LeaveCriticalSection(&context.lock);
+
+	// Values with #Variables# can only be resolved by ReadIniFile.
+	for (const auto& section : *sections)
+	{
+		for (const auto& entry : section.entries)
+		{
+			if (_wcsnicmp(entry.key.c_str(), L"@Include", 8) != 0) continue;
+
+			std::wstring value = entry.value;
+			if (value.length() >= 2 && (value[0] == L'"' || value[0] == L'\'') && value.back() == value[0])
+			{
+				value.assign(value, 1, value.length() - 2);
+			}
+
+			if (value.empty() || value.find(L'#') != std::wstring::npos) continue;
+
+			if (!PathUtil::IsAbsolute(value))
+			{
+				value.insert(0, PathUtil::GetFolderFromFilePath(iniFile));
+			}
+
+			PrefetchIniFile(context, value, depth + 1);
+		}
+	}
+}
+
+std::wstring ConfigParser::GetPrefetchKey(const std::wstring& iniFile)
+{
+	WCHAR buffer[MAX_PATH];
+	DWORD len = GetFullPathName(iniFile.c_str(), _countof(buffer), buffer, nullptr);
+	std::wstring key = (len > 0 && len < _countof(buffer)) ? buffer : iniFile;
+	return StrToUpperC(key);
 }
 
 /*
@@ -1541,13 +1965,16 @@ void ConfigParser::SetValue(const std::wstring& strSection, const std::wstring&
 {
 	// LogDebugF(L"[%s] %s=%s (size: %i)", strSection.c_str(), strKey.c_str(), strValue.c_str(), (int)m_Values.size());
 
-	std::wstring strTmp;
-	strTmp.reserve(strSection.size() + 1 + strKey.size());
-	strTmp = strSection;
-	strTmp += L'~';
-	strTmp += strKey;
-
-	m_Values[StrToUpperC(strTmp)] = strValue;
+	const UINT section = InternName(strSection.c_str());
+	const UINT key = InternName(strKey.c_str());
+	std::unordered_map<UINT, std::wstring>& values = m_Values[section];
+	auto result = values.emplace(key, strValue);
+	if (result.second || (*result.first).second != strValue)
+	{
+		(*result.first).second = strValue;
+		m_Templates.erase(GetTemplateKey(section, key));
+		++m_ValuesVersion;
+	}
 }
 
 /*
@@ -1556,16 +1983,14 @@ void ConfigParser::SetValue(const std::wstring& strSection, const std::wstring&
 */
 void ConfigParser::DeleteValue(const std::wstring& strSection, const std::wstring& strKey)
 {
-	std::wstring strTmp;
-	strTmp.reserve(strSection.size() + 1 + strKey.size());
-	strTmp = strSection;
-	strTmp += L'~';
-	strTmp += strKey;
+	UINT section, key;
+	if (!FindName(strSection.c_str(), section) || !FindName(strKey.c_str(), key)) return;
 
-	std::unordered_map<std::wstring, std::wstring>::const_iterator iter = m_Values.find(StrToUpperC(strTmp));
-	if (iter != m_Values.end())
+	auto iter = m_Values.find(section);
+	if (iter != m_Values.end() && (*iter).second.erase(key) != 0)
 	{
-		m_Values.erase(iter);
+		m_Templates.erase(GetTemplateKey(section, key));
+		++m_ValuesVersion;
 	}
 }
 
@@ -1575,12 +2000,134 @@ void ConfigParser::DeleteValue(const std::wstring& strSection, const std::wstrin
 */
 const std::wstring& ConfigParser::GetValue(const std::wstring& strSection, const std::wstring& strKey, const std::wstring& strDefault)
 {
-	std::wstring strTmp;
-	strTmp.reserve(strSection.size() + 1 + strKey.size());
-	strTmp = strSection;
-	strTmp += L'~';
-	strTmp += strKey;
-
-	std::unordered_map<std::wstring, std::wstring>::const_iterator iter = m_Values.find(StrToUpperC(strTmp));
-	return (iter != m_Values.end()) ? (*iter).second : strDefault;
+	const std::wstring* value = FindValue(strSection.c_str(), strKey.c_str());
+	return value ? *value : strDefault;
+}
+
+const std::wstring* ConfigParser::FindValue(UINT section, UINT key) const
+{
+	auto iter = m_Values.find(section);
+	if (iter != m_Values.end())
+	{
+		auto jt = (*iter).second.find(key);
+		if (jt != (*iter).second.end())
+		{
+			return &(*jt).second;
+		}
+	}
+
+	return nullptr;
+}
+
+const std::wstring* ConfigParser::FindValue(const WCHAR* section, const WCHAR* key) const
+{
+	UINT sectionAtom, keyAtom;
+	if (FindName(section, sectionAtom) && FindName(key, keyAtom))
+	{
+		return FindValue(sectionAtom, keyAtom);
+	}
+
+	return nullptr;
+}
+
+void ConfigParser::SetStyleTemplate(const std::wstring& strStyle)
+{
+	static const std::wstring delim(1, L'|');
+
+	m_StyleTemplate.clear();
+	for (const auto& style : Tokenize(strStyle, delim))
+	{
+		m_StyleTemplate.push_back(InternName(style.c_str()));
+	}
+}
+
+/*
+** Returns the atom of the section or key name, interning the name if it is new. Names are
+** case-insensitive.
+**
+*/
+UINT ConfigParser::InternName(const WCHAR* name)
+{
+	UINT atom;
+	if (FindName(name, atom)) return atom;
+
+	// Keep the table at most half full so that probe sequences stay short.
+	if ((m_Names.size() + 1) * 2 > m_NameSlots.size())
+	{
+		const NameSlot emptySlot = { 0, NO_ATOM };
+		std::vector<NameSlot> slots(m_NameSlots.empty() ? 256 : m_NameSlots.size() * 2, emptySlot);
+		const size_t mask = slots.size() - 1;
+		for (const auto& slot : m_NameSlots)
+		{
+			if (slot.atom == NO_ATOM) continue;
+
+			size_t i = slot.hash & mask;
+			while (slots[i].atom != NO_ATOM) i = (i + 1) & mask;
+			slots[i] = slot;
+		}
+
+		m_NameSlots.swap(slots);
+	}
+
+	atom = (UINT)m_Names.size();
+	m_Names.emplace_back(name);
+
+	const size_t hash = HashName(name);
+	const size_t mask = m_NameSlots.size() - 1;
+	size_t i = hash & mask;
+	while (m_NameSlots[i].atom != NO_ATOM) i = (i + 1) & mask;
+	m_NameSlots[i].hash = hash;
+	m_NameSlots[i].atom = atom;
+
+	return atom;
+}
+
+/*
+** Looks up the atom of the section or key name without allocating. Returns false if the name
+** has not been interned.
+**
+*/
+bool ConfigParser::FindName(const WCHAR* name, UINT& atom) const
+{
+	if (m_NameSlots.empty()) return false;
+
+	const size_t hash = HashName(name);
+	const size_t mask = m_NameSlots.size() - 1;
+	for (size_t i = hash & mask; m_NameSlots[i].atom != NO_ATOM; i = (i + 1) & mask)
+	{
+		const NameSlot& slot = m_NameSlots[i];
+		if (slot.hash == hash && NameEquals(m_Names[slot.atom].c_str(), name))
+		{
+			atom = slot.atom;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+** Case-insensitive FNV-1a hash.
+**
+*/
+size_t ConfigParser::HashName(const WCHAR* name)
+{
+	size_t hash = 2166136261U;
+	for ( ; *name; ++name)
+	{
+		hash ^= (size_t)towupper(*name);
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+bool ConfigParser::NameEquals(const WCHAR* name1, const WCHAR* name2)
+{
+	for ( ; *name1 && *name2; ++name1, ++name2)
+	{
+		if (*name1 != *name2 && towupper(*name1) != towupper(*name2)) return false;
+	}
+
+	return *name1 == *name2;
 }
@@ -26,10 +26,14 @@
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
+#include <memory>
+#include <utility>
 #include <algorithm>
 #include <cstdint>
 #include <ole2.h>  // For Gdiplus.h.
 #include <gdiplus.h>
+#include "../Common/IniReader.h"
+#include "../Common/MathParser.h"
 
 class Rainmeter;
 class MeterWindow;
@@ -45,6 +49,21 @@ public:
 	ConfigParser(const ConfigParser& other) = delete;
 	ConfigParser& operator=(ConfigParser other) = delete;
 
+	// Inputs used while reading the options of a section between BeginDependencies() and
+	// EndDependencies(). With DynamicVariables, the options need to be read again only if
+	// HaveDependenciesChanged() returns true.
+	struct Dependencies
+	{
+		Dependencies() : recorded(false), valuesVersion(), variablesVersion(), monitorVariablesVersion() {}
+
+		bool recorded;				// False if never recorded or if an untracked input was used
+		UINT valuesVersion;
+		UINT variablesVersion;
+		UINT monitorVariablesVersion;
+		std::vector<std::pair<Measure*, std::wstring>> measures;				// Measure and its value when read
+		std::vector<std::pair<std::wstring, std::wstring>> sectionVariables;	// [Section:Variable] and its value when read
+	};
+
 	void Initialize(const std::wstring& filename, MeterWindow* meterWindow = nullptr, LPCTSTR skinSection = nullptr, const std::wstring* resourcePath = nullptr);
 
 	void AddMeasure(Measure* pMeasure);
@@ -60,7 +79,7 @@ public:
 	void SetValue(const std::wstring& strSection, const std::wstring& strKey, const std::wstring& strValue);
 	void DeleteValue(const std::wstring& strSection, const std::wstring& strKey);
 
-	void SetStyleTemplate(const std::wstring& strStyle) { static const std::wstring delim(1, L'|'); Tokenize(strStyle, delim).swap(m_StyleTemplate); }
+	void SetStyleTemplate(const std::wstring& strStyle);
 	void ClearStyleTemplate() { m_StyleTemplate.clear(); }
 
 	bool GetLastReplaced() { return m_LastReplaced; }
@@ -70,6 +89,11 @@ public:
 
 	void ResetMonitorVariables(MeterWindow* meterWindow = nullptr);
 
+	void BeginDependencies(Dependencies& dependencies);
+	void EndDependencies() { m_Dependencies = nullptr; }
+	bool HaveDependenciesChanged(const Dependencies& dependencies);
+	void AddUntrackedDependency() { if (m_Dependencies) m_Dependencies->recorded = false; }
+
 	const std::wstring& ReadString(LPCTSTR section, LPCTSTR key, LPCTSTR defValue, bool bReplaceMeasures = true);
 	bool IsKeyDefined(LPCTSTR section, LPCTSTR key);
 	bool IsValueDefined(LPCTSTR section, LPCTSTR key);
@@ -99,20 +123,112 @@ public:
 	static Gdiplus::Rect ParseRect(LPCTSTR string);
 	static RECT ParseRECT(LPCTSTR string);
 
-	static void ClearMultiMonitorVariables() { c_MonitorVariables.clear(); }
+	static void ClearMultiMonitorVariables() { c_MonitorVariables.clear(); ++c_MonitorVariablesVersion; }
 	static void UpdateWorkareaVariables() { SetMultiMonitorVariables(false); }
 
+	static void PrefetchIniFiles(const std::vector<std::wstring>& iniFiles);
+	static void ClearPrefetchedIniFiles() { c_PrefetchedFiles.clear(); }
+
 private:
+	// Option value split into literal spans and [Measure]/[Section:Variable] references after the
+	// #Variables# have been replaced. Built once per value and rebuilt only when the variables (or
+	// the set of measures and meters) change, so that reading the value only needs to concatenate
+	// the spans and the current values of the references.
+	struct ValueTemplate
+	{
+		enum class TokenType : BYTE
+		{
+			Literal,
+			Measure,
+			SectionVariable
+		};
+
+		struct Token
+		{
+			TokenType type;
+			size_t start;		// Span in |expanded|
+			size_t length;
+			Measure* measure;	// TokenType::Measure only
+		};
+
+		ValueTemplate() :
+			sectionDependent(false), variablesVersion(), monitorVariablesVersion(), variablesReplaced(false),
+			tokenized(false), measureCount(), meterCount(), isLiteral(true), hasReferences(false) {}
+
+		std::wstring raw;				// Value the template was built from
+		bool sectionDependent;			// True if the value may use #CURRENTSECTION#
+		std::wstring section;			// Section |expanded| was built for if |sectionDependent|
+
+		UINT variablesVersion;
+		UINT monitorVariablesVersion;
+		bool variablesReplaced;
+		std::wstring expanded;			// |raw| with #Variables# replaced
+
+		bool tokenized;
+		size_t measureCount;			// Number of measures and meters when tokenized
+		size_t meterCount;
+		bool isLiteral;					// True if |expanded| is the final value
+		bool hasReferences;
+		std::vector<Token> tokens;
+	};
+
+	static UINT64 GetTemplateKey(UINT section, UINT key) { return ((UINT64)section << 32) | key; }
+	void ReadTemplate(UINT64 templateKey, const std::wstring& rawValue, const WCHAR* section, bool bReplaceMeasures, std::wstring& result);
+	void TokenizeTemplate(ValueTemplate& tmpl);
+
+	// Section and key names are interned to atoms (indices into m_Names) so that values can be
+	// stored per section and looked up without building and upper-casing a combined key.
+	struct NameSlot
+	{
+		size_t hash;
+		UINT atom;				// NO_ATOM if the slot is empty
+	};
+
+	static const UINT NO_ATOM = (UINT)-1;
+
+	UINT InternName(const WCHAR* name);
+	bool FindName(const WCHAR* name, UINT& atom) const;
+	static size_t HashName(const WCHAR* name);
+	static bool NameEquals(const WCHAR* name1, const WCHAR* name2);
+
+	const std::wstring* FindValue(UINT section, UINT key) const;
+	const std::wstring* FindValue(const WCHAR* section, const WCHAR* key) const;
+
 	void SetBuiltInVariables(const std::wstring& filename, const std::wstring* resourcePath, MeterWindow* meterWindow);
 
 	void ReadVariables();
 
+	typedef std::shared_ptr<const std::vector<IniReader::Section>> IniSectionsPtr;
+
+	struct PrefetchContext
+	{
+		CRITICAL_SECTION lock;		// Guards c_PrefetchedFiles while prefetching
+		volatile LONG pending;
+		HANDLE doneEvent;
+	};
+
+	struct PrefetchItem
+	{
+		PrefetchContext* context;
+		std::wstring iniFile;
+	};
+
 	void ReadIniFile(const std::wstring& iniFile, LPCTSTR skinSection = nullptr, int depth = 0);
+	static bool ReadIniSections(const std::wstring& iniFile, std::vector<IniReader::Section>& sections);
+
+	static std::wstring GetPrefetchKey(const std::wstring& iniFile);
+	static void PrefetchIniFile(PrefetchContext& context, const std::wstring& iniFile, int depth);
+	static DWORD WINAPI PrefetchThreadProc(void* param);
 
 	void SetAutoSelectedMonitorVariables(MeterWindow* meterWindow);
 
 	bool GetSectionVariable(std::wstring& strVariable, std::wstring& strValue);
 
+	const WCHAR* CheckedParseFormula(const WCHAR* formula, double* result);
+
+	void AddMeasureDependency(Measure* measure, const WCHAR* value);
+	void AddSectionVariableDependency(const std::wstring& variable, const std::wstring& value);
+
 	static void SetVariable(std::unordered_map<std::wstring, std::wstring>& variables, const std::wstring& strVariable, const std::wstring& strValue);
 	static void SetVariable(std::unordered_map<std::wstring, std::wstring>& variables, const WCHAR* strVariable, const WCHAR* strValue);
 
@@ -125,7 +241,7 @@ private:
 
 	std::unordered_map<std::wstring, Measure*> m_Measures;
 
-	std::vector<std::wstring> m_StyleTemplate;
+	std::vector<UINT> m_StyleTemplate;		// Atoms of the style sections
 
 	bool m_LastReplaced;
 	bool m_LastDefaultUsed;
@@ -134,7 +250,10 @@ private:
 	std::wstring* m_CurrentSection;
 
 	std::list<std::wstring> m_Sections;		// Ordered section
-	std::unordered_map<std::wstring, std::wstring> m_Values;
+	std::unordered_map<UINT, std::unordered_map<UINT, std::wstring>> m_Values;	// Section atom -> key atom -> value
+	std::vector<std::wstring> m_Names;		// Interned names indexed by atom
+	std::vector<NameSlot> m_NameSlots;		// Open addressing table of m_Names, size is a power of two
+	UINT m_ValuesVersion;
 
 	std::unordered_set<std::wstring> m_FoundSections;
 	std::list<std::wstring> m_ListVariables;
@@ -142,10 +261,23 @@ private:
 
 	std::unordered_map<std::wstring, std::wstring> m_BuiltInVariables;
 	std::unordered_map<std::wstring, std::wstring> m_Variables;
+	UINT m_VariablesVersion;
+
+	// Keyed by GetTemplateKey() of the section and key the value is stored under. Removed when the
+	// value is set or deleted.
+	std::unordered_map<UINT64, ValueTemplate> m_Templates;
+
+	std::unordered_map<std::wstring, MathParser::Program> m_Formulas;
+
+	Dependencies* m_Dependencies;	// Non-null while recording
 
 	MeterWindow* m_MeterWindow;
 
 	static std::unordered_map<std::wstring, std::wstring> c_MonitorVariables;
+
+	// Files parsed ahead of time by PrefetchIniFiles. Keyed by GetPrefetchKey.
+	static std::unordered_map<std::wstring, IniSectionsPtr> c_PrefetchedFiles;
+	static UINT c_MonitorVariablesVersion;
 };
 
 #endif
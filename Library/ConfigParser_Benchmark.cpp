@@ -0,0 +1,364 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Standalone benchmark comparing the option lookups of ConfigParser::ReadString() with the
+// previous implementation on a large generated skin. Previously, every lookup copied the section,
+// key and default value, built an upper-cased SECTION~KEY string and hashed it, once for the
+// section and once per MeterStyle. Now section and key names are interned to atoms and values are
+// stored per section. The classes below mirror the lookups in ConfigParser.cpp. This file is not
+// part of any project and can be built on any platform, for example:
+//
+//   g++ -O2 -o ConfigParser_Benchmark ConfigParser_Benchmark.cpp
+//   cl /O2 /EHsc ConfigParser_Benchmark.cpp
+
+#include <chrono>
+#include <cstdio>
+#include <cwctype>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+std::wstring StrToUpper(std::wstring str)
+{
+	for (auto& ch : str) ch = (wchar_t)towupper(ch);
+	return str;
+}
+
+// Same as ConfigParser before interning.
+class OldValues
+{
+public:
+	void SetValue(const std::wstring& section, const std::wstring& key, const std::wstring& value)
+	{
+		m_Values[StrToUpper(section + L'~' + key)] = value;
+	}
+
+	void SetStyleTemplate(const std::vector<std::wstring>& styles) { m_StyleTemplate = styles; }
+
+	// Returns false if the default value was used.
+	bool ReadString(const wchar_t* section, const wchar_t* key, const wchar_t* defValue, std::wstring& result)
+	{
+		const std::wstring strSection = section;
+		const std::wstring strKey = key;
+		const std::wstring strDefault = defValue;
+
+		const std::wstring* value = &GetValue(strSection, strKey, strDefault);
+		for (auto iter = m_StyleTemplate.rbegin(); value == &strDefault && iter != m_StyleTemplate.rend(); ++iter)
+		{
+			value = &GetValue(*iter, strKey, strDefault);
+		}
+
+		result = *value;
+		return value != &strDefault;
+	}
+
+private:
+	const std::wstring& GetValue(const std::wstring& section, const std::wstring& key, const std::wstring& defValue)
+	{
+		std::wstring strTmp;
+		strTmp.reserve(section.size() + 1 + key.size());
+		strTmp = section;
+		strTmp += L'~';
+		strTmp += key;
+
+		auto iter = m_Values.find(StrToUpper(strTmp));
+		return (iter != m_Values.end()) ? (*iter).second : defValue;
+	}
+
+	std::unordered_map<std::wstring, std::wstring> m_Values;
+	std::vector<std::wstring> m_StyleTemplate;
+};
+
+// Same as the current ConfigParser.
+class NewValues
+{
+public:
+	void SetValue(const std::wstring& section, const std::wstring& key, const std::wstring& value)
+	{
+		m_Values[InternName(section.c_str())][InternName(key.c_str())] = value;
+	}
+
+	void SetStyleTemplate(const std::vector<std::wstring>& styles)
+	{
+		m_StyleTemplate.clear();
+		for (const auto& style : styles)
+		{
+			m_StyleTemplate.push_back(InternName(style.c_str()));
+		}
+	}
+
+	// Returns false if the default value was used.
+	bool ReadString(const wchar_t* section, const wchar_t* key, const wchar_t* defValue, std::wstring& result)
+	{
+		const std::wstring* value = nullptr;
+		unsigned int keyAtom;
+		if (FindName(key, keyAtom))
+		{
+			unsigned int sectionAtom;
+			if (FindName(section, sectionAtom))
+			{
+				value = FindValue(sectionAtom, keyAtom);
+			}
+
+			for (auto iter = m_StyleTemplate.rbegin(); !value && iter != m_StyleTemplate.rend(); ++iter)
+			{
+				value = FindValue(*iter, keyAtom);
+			}
+		}
+
+		if (!value)
+		{
+			result = defValue;
+			return false;
+		}
+
+		result = *value;
+		return true;
+	}
+
+private:
+	struct NameSlot
+	{
+		size_t hash;
+		unsigned int atom;
+	};
+
+	static const unsigned int NO_ATOM = (unsigned int)-1;
+
+	unsigned int InternName(const wchar_t* name)
+	{
+		unsigned int atom;
+		if (FindName(name, atom)) return atom;
+
+		if ((m_Names.size() + 1) * 2 > m_NameSlots.size())
+		{
+			const NameSlot emptySlot = { 0, NO_ATOM };
+			std::vector<NameSlot> slots(m_NameSlots.empty() ? 256 : m_NameSlots.size() * 2, emptySlot);
+			const size_t mask = slots.size() - 1;
+			for (const auto& slot : m_NameSlots)
+			{
+				if (slot.atom == NO_ATOM) continue;
+
+				size_t i = slot.hash & mask;
+				while (slots[i].atom != NO_ATOM) i = (i + 1) & mask;
+				slots[i] = slot;
+			}
+
+			m_NameSlots.swap(slots);
+		}
+
+		atom = (unsigned int)m_Names.size();
+		m_Names.emplace_back(name);
+
+		const size_t hash = HashName(name);
+		const size_t mask = m_NameSlots.size() - 1;
+		size_t i = hash & mask;
+		while (m_NameSlots[i].atom != NO_ATOM) i = (i + 1) & mask;
+		m_NameSlots[i].hash = hash;
+		m_NameSlots[i].atom = atom;
+		return atom;
+	}
+
+	bool FindName(const wchar_t* name, unsigned int& atom) const
+	{
+		if (m_NameSlots.empty()) return false;
+
+		const size_t hash = HashName(name);
+		const size_t mask = m_NameSlots.size() - 1;
+		for (size_t i = hash & mask; m_NameSlots[i].atom != NO_ATOM; i = (i + 1) & mask)
+		{
+			const NameSlot& slot = m_NameSlots[i];
+			if (slot.hash == hash && NameEquals(m_Names[slot.atom].c_str(), name))
+			{
+				atom = slot.atom;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	const std::wstring* FindValue(unsigned int section, unsigned int key) const
+	{
+		auto iter = m_Values.find(section);
+		if (iter != m_Values.end())
+		{
+			auto jt = (*iter).second.find(key);
+			if (jt != (*iter).second.end())
+			{
+				return &(*jt).second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	static size_t HashName(const wchar_t* name)
+	{
+		size_t hash = 2166136261U;
+		for ( ; *name; ++name)
+		{
+			hash ^= (size_t)towupper(*name);
+			hash *= 16777619U;
+		}
+
+		return hash;
+	}
+
+	static bool NameEquals(const wchar_t* name1, const wchar_t* name2)
+	{
+		for ( ; *name1 && *name2; ++name1, ++name2)
+		{
+			if (*name1 != *name2 && towupper(*name1) != towupper(*name2)) return false;
+		}
+
+		return *name1 == *name2;
+	}
+
+	std::unordered_map<unsigned int, std::unordered_map<unsigned int, std::wstring>> m_Values;
+	std::vector<std::wstring> m_Names;
+	std::vector<NameSlot> m_NameSlots;
+	std::vector<unsigned int> m_StyleTemplate;
+};
+
+template<typename Values>
+void ReadAll(
+	Values& values, const std::vector<std::wstring>& meters, const std::vector<std::vector<std::wstring>>& meterStyles,
+	const std::vector<std::wstring>& options, size_t& totalLength)
+{
+	std::wstring result;
+	for (size_t i = 0; i < meters.size(); ++i)
+	{
+		values.SetStyleTemplate(meterStyles[i]);
+		for (const auto& option : options)
+		{
+			values.ReadString(meters[i].c_str(), option.c_str(), L"", result);
+			totalLength += result.size();
+		}
+	}
+}
+
+template<typename Func>
+double Measure(Func func, int iterations)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		func(i);
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+}  // namespace
+
+int main()
+{
+	// A skin with |meterCount| meters that each define a few options and get the rest from two
+	// MeterStyle sections. Each meter reads |optionCount| options as Meter::ReadOptions() would,
+	// most of which are not defined anywhere.
+	const int meterCount = 2000;
+	const int styleCount = 20;
+	const int optionCount = 60;
+
+	std::vector<std::wstring> options;
+	for (int i = 0; i < optionCount; ++i)
+	{
+		options.push_back(L"Option" + std::to_wstring(i));
+	}
+
+	std::vector<std::wstring> meters;
+	std::vector<std::vector<std::wstring>> meterStyles;
+	OldValues oldValues;
+	NewValues newValues;
+	auto setValue = [&](const std::wstring& section, const std::wstring& key, const std::wstring& value)
+	{
+		oldValues.SetValue(section, key, value);
+		newValues.SetValue(section, key, value);
+	};
+
+	for (int i = 0; i < styleCount; ++i)
+	{
+		const std::wstring style = L"Style" + std::to_wstring(i);
+		for (int j = i % 5; j < optionCount; j += 5)
+		{
+			setValue(style, options[j], style + L"Value" + std::to_wstring(j));
+		}
+	}
+
+	for (int i = 0; i < meterCount; ++i)
+	{
+		const std::wstring meter = L"Meter" + std::to_wstring(i);
+		meters.push_back(meter);
+
+		std::vector<std::wstring> styles;
+		styles.push_back(L"style" + std::to_wstring(i % styleCount));
+		styles.push_back(L"STYLE" + std::to_wstring((i + 7) % styleCount));
+		meterStyles.push_back(styles);
+
+		for (int j = i % 7; j < optionCount; j += 7)
+		{
+			setValue(meter, options[j], meter + L"Value" + std::to_wstring(j));
+		}
+	}
+
+	// Read the options with different case than they were set with, as skins often do.
+	std::vector<std::wstring> readOptions;
+	for (const auto& option : options)
+	{
+		readOptions.push_back(StrToUpper(option));
+	}
+
+	bool identical = true;
+	size_t found = 0;
+	std::wstring oldResult, newResult;
+	for (int i = 0; i < meterCount; ++i)
+	{
+		oldValues.SetStyleTemplate(meterStyles[i]);
+		newValues.SetStyleTemplate(meterStyles[i]);
+		for (const auto& option : readOptions)
+		{
+			const bool oldFound = oldValues.ReadString(meters[i].c_str(), option.c_str(), L"def", oldResult);
+			const bool newFound = newValues.ReadString(meters[i].c_str(), option.c_str(), L"def", newResult);
+			identical = identical && oldFound == newFound && oldResult == newResult;
+			if (oldFound) ++found;
+		}
+	}
+
+	size_t oldLength = 0;
+	size_t newLength = 0;
+	const int iterations = 10;
+	const double reads = (double)meterCount * optionCount;
+	const double oldTime = Measure([&](int)
+	{
+		ReadAll(oldValues, meters, meterStyles, readOptions, oldLength);
+	}, iterations) / reads;
+	const double newTime = Measure([&](int)
+	{
+		ReadAll(newValues, meters, meterStyles, readOptions, newLength);
+	}, iterations) / reads;
+	identical = identical && oldLength == newLength;
+
+	printf("%d meters, %d options per meter, %zu of %.0f options defined\n", meterCount, optionCount, found, reads);
+	printf("%14s %14s %8s\n", "old (ns/read)", "new (ns/read)", "speedup");
+	printf("%14.1f %14.1f %7.2fx\n", oldTime, newTime, oldTime / newTime);
+	printf("Results %s\n", identical ? "identical" : "DIFFER");
+	return identical ? 0 : 1;
+}
@@ -18,8 +18,23 @@
 
 #include "StdAfx.h"
 #include "ConfigParser.h"
+#include "Measure.h"
 #include "../Common/UnitTest.h"
 
+// Measure with a fixed string value for testing measure references.
+class TestMeasure : public Measure
+{
+public:
+	TestMeasure(const WCHAR* name, const WCHAR* value) : Measure(nullptr, name), m_String(value) {}
+
+	virtual const WCHAR* GetStringValue() { return m_String.c_str(); }
+
+	std::wstring m_String;
+
+protected:
+	virtual void UpdateValue() {}
+};
+
 TEST_CLASS(Library_ConfigParser_Test)
 {
 public:
@@ -74,6 +89,38 @@ public:
 		Assert::IsTrue(parser.ReadFloats(L"A", L"FloatsNA").empty());
 	}
 
+	TEST_METHOD(TestValues)
+	{
+		ConfigParser parser;
+		parser.Initialize(L"");  // TODO: Better way to initialize without file.
+
+		parser.SetValue(L"Section", L"Key", L"abc");
+		Assert::AreEqual(parser.ReadString(L"SECTION", L"key", L"").c_str(), L"abc");
+		Assert::AreEqual(parser.GetValue(L"section", L"KEY", L"def").c_str(), L"abc");
+		Assert::AreEqual(parser.ReadString(L"Section", L"Other", L"def").c_str(), L"def");
+		Assert::AreEqual(parser.ReadString(L"Other", L"Key", L"def").c_str(), L"def");
+
+		parser.SetValue(L"SECTION", L"KEY", L"ghi");
+		Assert::AreEqual(parser.ReadString(L"Section", L"Key", L"").c_str(), L"ghi");
+
+		// Later styles take precedence and the section itself takes precedence over the styles.
+		parser.SetValue(L"Style1", L"A", L"1A");
+		parser.SetValue(L"Style1", L"B", L"1B");
+		parser.SetValue(L"Style2", L"B", L"2B");
+		parser.SetValue(L"Meter", L"C", L"MC");
+		parser.SetStyleTemplate(L"Style1 | style2");
+		Assert::AreEqual(parser.ReadString(L"Meter", L"A", L"").c_str(), L"1A");
+		Assert::AreEqual(parser.ReadString(L"Meter", L"B", L"").c_str(), L"2B");
+		Assert::AreEqual(parser.ReadString(L"Meter", L"C", L"").c_str(), L"MC");
+		Assert::AreEqual(parser.ReadString(L"Meter", L"D", L"def").c_str(), L"def");
+		parser.ClearStyleTemplate();
+		Assert::AreEqual(parser.ReadString(L"Meter", L"A", L"def").c_str(), L"def");
+
+		parser.DeleteValue(L"section", L"key");
+		Assert::IsFalse(parser.IsKeyDefined(L"Section", L"Key"));
+		parser.DeleteValue(L"Unknown", L"Key");
+	}
+
 	TEST_METHOD(TestVariables)
 	{
 		ConfigParser parser;
@@ -110,4 +157,96 @@ public:
 		parser.SetValue(L"A", L"String", L"#Var#");
 		Assert::AreNotEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"BuiltIn");
 	}
+
+	TEST_METHOD(TestMeasures)
+	{
+		ConfigParser parser;
+		parser.Initialize(L"");  // TODO: Better way to initialize without file.
+
+		// The value of Measure contains a reference to Other, which must not be replaced.
+		TestMeasure measure(L"Measure", L"[Other]");
+		TestMeasure other(L"Other", L"abc");
+		parser.AddMeasure(&measure);
+		parser.AddMeasure(&other);
+
+		parser.SetValue(L"A", L"String", L"[Measure]");
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"[Other]");
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"", false).c_str(), L"[Measure]");
+
+		measure.m_String = L"[*Other*]";
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"[*Other*]");
+
+		// Escaped references are not replaced.
+		parser.SetValue(L"A", L"String", L"[*Measure*] [Other]");
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"[Measure] abc");
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"", false).c_str(), L"[*Measure*] [Other]");
+
+		other.m_String = L"def";
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"").c_str(), L"[Measure] def");
+
+		parser.DeleteValue(L"A", L"String");
+		Assert::AreEqual(parser.ReadString(L"A", L"String", L"def").c_str(), L"def");
+	}
+
+	TEST_METHOD(TestDependencies)
+	{
+		ConfigParser parser;
+		parser.Initialize(L"");  // TODO: Better way to initialize without file.
+
+		TestMeasure measure(L"Measure", L"abc");
+		TestMeasure other(L"Other", L"abc");
+		parser.AddMeasure(&measure);
+		parser.AddMeasure(&other);
+		parser.SetVariable(L"Var", L"1");
+		parser.SetValue(L"A", L"String", L"#Var# [Measure]");
+
+		ConfigParser::Dependencies dependencies;
+		Assert::IsTrue(parser.HaveDependenciesChanged(dependencies));
+
+		auto readOptions = [&]()
+		{
+			parser.BeginDependencies(dependencies);
+			parser.ReadString(L"A", L"String", L"");
+
+			// Measures replaced outside of ReadString are tracked as well.
+			std::wstring string = L"[Other]";
+			parser.ReplaceMeasures(string);
+			parser.EndDependencies();
+		};
+
+		// The reread is skipped if the variable and the measure value are unchanged.
+		readOptions();
+		Assert::IsFalse(parser.HaveDependenciesChanged(dependencies));
+		Assert::IsFalse(parser.HaveDependenciesChanged(dependencies));
+
+		measure.m_String = L"def";
+		Assert::IsTrue(parser.HaveDependenciesChanged(dependencies));
+		readOptions();
+		Assert::IsFalse(parser.HaveDependenciesChanged(dependencies));
+
+		other.m_String = L"def";
+		Assert::IsTrue(parser.HaveDependenciesChanged(dependencies));
+		readOptions();
+		Assert::IsFalse(parser.HaveDependenciesChanged(dependencies));
+
+		parser.SetVariable(L"Var", L"2");
+		Assert::IsTrue(parser.HaveDependenciesChanged(dependencies));
+		readOptions();
+		Assert::IsFalse(parser.HaveDependenciesChanged(dependencies));
+
+		parser.SetValue(L"A", L"String", L"[Measure]");
+		Assert::IsTrue(parser.HaveDependenciesChanged(dependencies));
+		readOptions();
+		Assert::IsFalse(parser.HaveDependenciesChanged(dependencies));
+
+		// Values with environment variables are always read again.
+		parser.SetValue(L"A", L"String", L"%RAINMETER_TEST% [Measure]");
+		readOptions();
+		Assert::IsTrue(parser.HaveDependenciesChanged(dependencies));
+
+		parser.BeginDependencies(dependencies);
+		parser.AddUntrackedDependency();
+		parser.EndDependencies();
+		Assert::IsTrue(parser.HaveDependenciesChanged(dependencies));
+	}
 };
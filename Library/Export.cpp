@@ -33,6 +33,12 @@ LPCWSTR __stdcall RmReadString(void* rm, LPCWSTR option, LPCWSTR defValue, BOOL
 	NULLCHECK(defValue);
 
 	MeasurePlugin* measure = (MeasurePlugin*)rm;
+	if (MeasurePlugin::IsAsyncUpdateThread())
+	{
+		measure->LogAsyncCallError(L"RmReadString");
+		return defValue;
+	}
+
 	ConfigParser& parser = measure->GetMeterWindow()->GetParser();
 	return parser.ReadString(measure->GetName(), option, defValue, replaceMeasures != FALSE).c_str();
 }
@@ -42,6 +48,12 @@ double __stdcall RmReadFormula(void* rm, LPCWSTR option, double defValue)
 	NULLCHECK(option);
 
 	MeasurePlugin* measure = (MeasurePlugin*)rm;
+	if (MeasurePlugin::IsAsyncUpdateThread())
+	{
+		measure->LogAsyncCallError(L"RmReadFormula");
+		return defValue;
+	}
+
 	ConfigParser& parser = measure->GetMeterWindow()->GetParser();
 	return parser.ReadFloat(measure->GetName(), option, defValue);
 }
@@ -51,6 +63,12 @@ LPCWSTR __stdcall RmReplaceVariables(void* rm, LPCWSTR str)
 	NULLCHECK(str);
 
 	MeasurePlugin* measure = (MeasurePlugin*)rm;
+	if (MeasurePlugin::IsAsyncUpdateThread())
+	{
+		measure->LogAsyncCallError(L"RmReplaceVariables");
+		return str;
+	}
+
 	ConfigParser& parser = measure->GetMeterWindow()->GetParser();
 	g_Buffer = str;
 	parser.ReplaceVariables(g_Buffer);
@@ -63,6 +81,12 @@ LPCWSTR __stdcall RmPathToAbsolute(void* rm, LPCWSTR relativePath)
 	NULLCHECK(relativePath);
 
 	MeasurePlugin* measure = (MeasurePlugin*)rm;
+	if (MeasurePlugin::IsAsyncUpdateThread())
+	{
+		measure->LogAsyncCallError(L"RmPathToAbsolute");
+		return relativePath;
+	}
+
 	g_Buffer = relativePath;
 	measure->GetMeterWindow()->MakePathAbsolute(g_Buffer);
 	return g_Buffer.c_str();
@@ -112,6 +136,13 @@ void __stdcall RmExecute(void* skin, LPCWSTR command)
 	MeterWindow* mw = (MeterWindow*)skin;
 	if (command)
 	{
+		if (MeasurePlugin::IsAsyncUpdateThread())
+		{
+			// Don't wait for the UI thread as it may be waiting for the plugin.
+			GetRainmeter().DelayedExecuteCommand(command, mw);
+			return;
+		}
+
 		// WM_RAINMETER_EXECUTE used instead of ExecuteCommand for thread-safety
 		SendMessage(GetRainmeter().GetWindow(), WM_RAINMETER_EXECUTE, (WPARAM)mw, (LPARAM)command);
 	}
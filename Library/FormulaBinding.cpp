@@ -0,0 +1,47 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "StdAfx.h"
+#include "FormulaBinding.h"
+#include "Measure.h"
+#include "MeterWindow.h"
+
+void FormulaBinding::Bind(const MathParser::Program& program, MeterWindow* meterWindow)
+{
+	const size_t count = program.GetNameCount();
+	m_Measures.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		m_Measures[i] = meterWindow->GetMeasure(program.GetName(i));
+	}
+
+	m_Bound = true;
+}
+
+bool FormulaBinding::GetMeasureValue(size_t index, double* value, void* context)
+{
+	auto binding = (FormulaBinding*)context;
+	Measure* measure = binding->m_Measures[index];
+	if (measure)
+	{
+		*value = measure->GetValue();
+		return true;
+	}
+
+	return false;
+}
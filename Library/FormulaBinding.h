@@ -0,0 +1,53 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __FORMULABINDING_H__
+#define __FORMULABINDING_H__
+
+#include <windows.h>
+#include <vector>
+#include "../Common/MathParser.h"
+
+class Measure;
+class MeterWindow;
+
+// Binds the names of a compiled formula to the measures of the skin. The measures are looked up
+// once so that evaluating the formula does not need to compare names. The measures of a skin do
+// not change until the skin is refreshed, which also recreates the owner of the binding.
+class FormulaBinding
+{
+public:
+	FormulaBinding() : m_Bound(false) {}
+
+	void Bind(const MathParser::Program& program, MeterWindow* meterWindow);
+	void Reset() { m_Measures.clear(); m_Bound = false; }
+
+	bool IsBound() const { return m_Bound; }
+
+	// Returns nullptr if the name at |index| is not a measure.
+	Measure* GetMeasure(size_t index) const { return m_Measures[index]; }
+
+	// MathParser::GetIndexedValueFunc with the FormulaBinding as context.
+	static bool GetMeasureValue(size_t index, double* value, void* context);
+
+private:
+	std::vector<Measure*> m_Measures;
+	bool m_Bound;
+};
+
+#endif
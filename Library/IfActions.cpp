@@ -211,9 +211,23 @@ void IfActions::DoIfActions(Measure& measure, double value)
 		++i;
 		if (!item.value.empty() && (!item.tAction.empty() || !item.fAction.empty()))
 		{
+			if (item.program.IsEmpty() && item.compileError.empty())
+			{
+				const WCHAR* errMsg = MathParser::Compile(item.value.c_str(), item.program);
+				if (errMsg)
+				{
+					item.compileError = errMsg;
+				}
+			}
+
+			if (!item.binding.IsBound())
+			{
+				item.binding.Bind(item.program, measure.GetMeterWindow());
+			}
+
 			double result = 0.0f;
-			const WCHAR* errMsg = MathParser::Parse(
-				item.value.c_str(), &result, measure.GetCurrentMeasureValue, &measure);
+			const WCHAR* errMsg = !item.compileError.empty() ? item.compileError.c_str() : MathParser::EvaluateIndexed(
+				item.program, &result, FormulaBinding::GetMeasureValue, &item.binding);
 			if (errMsg != nullptr)
 			{
 				if (!item.parseError)
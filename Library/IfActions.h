@@ -22,6 +22,7 @@
 #include <windows.h>
 #include <string>
 #include <vector>
+#include "FormulaBinding.h"
 
 class ConfigParser;
 class Measure;
@@ -35,6 +36,9 @@ public:
 		value(),
 		tAction(),
 		fAction(),
+		program(),
+		binding(),
+		compileError(),
 		parseError(false),
 		tCommitted(false),
 		fCommitted(false)
@@ -44,6 +48,14 @@ public:
 
 	inline void Set(std::wstring value, std::wstring trueAction, std::wstring falseAction)
 	{
+		if (this->value != value)
+		{
+			// Recompiled on next use.
+			program.Clear();
+			binding.Reset();
+			compileError.clear();
+		}
+
 		this->value = value;
 		this->tAction = trueAction;
 		this->fAction = falseAction;
@@ -52,6 +64,9 @@ public:
 	std::wstring value;			// IfCondition/IfMatch
 	std::wstring tAction;		// IfTrueAction/IfMatchAction
 	std::wstring fAction;		// IfFalseAction/IfNotMatchAction
+	MathParser::Program program;	// Compiled IfCondition
+	FormulaBinding binding;			// Measures referenced by IfCondition
+	std::wstring compileError;		// Copied as MathParser may return a reused buffer
 	bool parseError;
 	bool tCommitted;
 	bool fCommitted;
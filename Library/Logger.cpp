@@ -28,21 +28,82 @@
 
 namespace {
 
-const size_t MAX_LOG_ENTIRES = 20;
+void FormatTimestamp(ULONGLONG elapsed, WCHAR (&buffer)[32])
+{
+	_snwprintf_s(
+		buffer,
+		_TRUNCATE,
+		L"%02llu:%02llu:%02llu.%03llu",
+		elapsed / (1000 * 60 * 60),
+		(elapsed / (1000 * 60)) % 60,
+		(elapsed / 1000) % 60,
+		elapsed % 1000);
+}
+
+// Writes the source string of |meterWindow| and |section| into |buffer| without allocating.
+void FormatSource(MeterWindow* meterWindow, Section* section, WCHAR (&buffer)[Logger::MAX_SOURCE_LENGTH])
+{
+	buffer[0] = L'\0';
+
+	if (meterWindow)
+	{
+		const std::wstring& folderPath = meterWindow->GetFolderPath();
+		_snwprintf_s(
+			buffer,
+			_TRUNCATE,
+			folderPath.empty() ? L"%s%s" : L"%s\\%s",
+			folderPath.c_str(),
+			meterWindow->GetFileName().c_str());
+	}
+
+	if (section)
+	{
+		const size_t len = wcslen(buffer);
+		_snwprintf_s(
+			buffer + len,
+			Logger::MAX_SOURCE_LENGTH - len,
+			_TRUNCATE,
+			meterWindow ? L" - [%s]" : L"[%s]",
+			section->GetOriginalName().c_str());
+	}
+}
+
+// Replaces the end of the truncated string in |buffer| with "...".
+template <size_t N>
+void MarkTruncated(WCHAR (&buffer)[N])
+{
+	wcscpy_s(buffer + N - 4, 4, L"...");
+}
+
+// Copies |str| into |buffer|. Returns true if it had to be truncated.
+template <size_t N>
+bool CopyString(WCHAR (&buffer)[N], const WCHAR* str)
+{
+	if (wcsncpy_s(buffer, str, _TRUNCATE) == STRUNCATE)
+	{
+		MarkTruncated(buffer);
+		return true;
+	}
+
+	return false;
+}
 
 }  // namespace
 
 Logger::Logger() :
-	m_LoggerCallback (nullptr)
+	m_LoggerCallback (nullptr),
+	m_StartTime(System::GetTickCount64()),
+	m_Processing(false),
+	m_Truncated(0),
+	m_HistoryStart(0),
+	m_HistoryCount(0)
 {
 	System::InitializeCriticalSection(&m_CsLog);
-	System::InitializeCriticalSection(&m_CsLogDelay);
 }
 
 Logger::~Logger()
 {
 	DeleteCriticalSection(&m_CsLog);
-	DeleteCriticalSection(&m_CsLogDelay);
 }
 
 Logger& Logger::GetInstance()
@@ -51,45 +112,121 @@ Logger& Logger::GetInstance()
 	return s_Logger;
 }
 
-void Logger::LogInternal(Level level, ULONGLONG timestamp, const WCHAR* source, const WCHAR* msg)
+/*
+** Debug messages are only logged in debug mode. Checked before anything is formatted.
+**
+*/
+bool Logger::IsLevelEnabled(Level level)
+{
+	return level != Level::Debug || GetRainmeter().GetDebug();
+}
+
+/*
+** Writes a message into the ring with |fill(Record&)| and processes the ring if no other thread is
+** doing so. Nothing is allocated unless the message is processed on this thread.
+**
+*/
+template <typename Fill>
+void Logger::Push(Level level, Fill fill)
 {
-	WCHAR timestampSz[128];
-	size_t len = _snwprintf_s(
-		timestampSz,
-		_TRUNCATE,
-		L"%02llu:%02llu:%02llu.%03llu",
-		timestamp / (1000 * 60 * 60),
-		(timestamp / (1000 * 60)) % 60,
-		(timestamp / 1000) % 60,
-		timestamp % 1000);
-
-	// Store up to MAX_LOG_ENTIRES entries.
-	Entry entry = {level, std::wstring(timestampSz, len), source, msg};
-	m_Entries.push_back(entry);
-	if (m_Entries.size() > MAX_LOG_ENTIRES)
+	const ULONGLONG elapsed = System::GetTickCount64() - m_StartTime;
+	m_Ring.Push([&](Record& record)
+	{
+		record.level = level;
+		record.elapsed = elapsed;
+		fill(record);
+	});
+
+	ProcessRecords();
+}
+
+void Logger::ProcessRecords()
+{
+	do
 	{
-		m_Entries.pop_front();
+		if (!TryEnterCriticalSection(&m_CsLog)) return;
+
+		// Records logged from the callback are processed by the loop below.
+		if (m_Processing)
+		{
+			LeaveCriticalSection(&m_CsLog);
+			return;
+		}
+
+		m_Processing = true;
+
+		while (m_Ring.Pop([&](Record& record) { LogInternal(record); }))
+		{
+		}
+
+		const size_t dropped = m_Ring.TakeDropped();
+		if (dropped > 0)
+		{
+			Record record;
+			record.level = Level::Warning;
+			record.elapsed = System::GetTickCount64() - m_StartTime;
+			record.source[0] = L'\0';
+			_snwprintf_s(record.message, _TRUNCATE, L"Log: %llu messages dropped", (ULONGLONG)dropped);
+			LogInternal(record);
+		}
+
+		const LONG truncated = InterlockedExchange(&m_Truncated, 0);
+		if (truncated > 0)
+		{
+			Record record;
+			record.level = Level::Warning;
+			record.elapsed = System::GetTickCount64() - m_StartTime;
+			record.source[0] = L'\0';
+			_snwprintf_s(
+				record.message, _TRUNCATE, L"Log: %li messages truncated to %u characters",
+				truncated, (UINT)(MAX_MESSAGE_LENGTH - 1));
+			LogInternal(record);
+		}
+
+		m_Processing = false;
+		LeaveCriticalSection(&m_CsLog);
+
+		// Another thread may have pushed a record while this thread was holding the lock.
 	}
+	while (m_Ring.IsReady());
+}
+
+void Logger::LogInternal(const Record& record)
+{
+	// Store up to MAX_LOG_ENTRIES entries.
+	if (m_HistoryCount < MAX_LOG_ENTRIES)
+	{
+		m_History[(m_HistoryStart + m_HistoryCount) % MAX_LOG_ENTRIES] = record;
+		++m_HistoryCount;
+	}
+	else
+	{
+		m_History[m_HistoryStart] = record;
+		m_HistoryStart = (m_HistoryStart + 1) % MAX_LOG_ENTRIES;
+	}
+
+	WCHAR timestampSz[32];
+	FormatTimestamp(record.elapsed, timestampSz);
 
 	// Call callback function
 	if (m_LoggerCallback != nullptr)
-		(*m_LoggerCallback)(entry.level, entry.timestamp.c_str(), source, msg);
+		(*m_LoggerCallback)(record.level, timestampSz, record.source, record.message);
 
 #ifdef _DEBUG
 
 	const WCHAR* levelSz =
-		(entry.level == Level::Error) ? L"ERRO" :
-		(entry.level == Level::Warning) ? L"WARN" :
-		(entry.level == Level::Notice) ? L"NOTE" :
+		(record.level == Level::Error) ? L"ERRO" :
+		(record.level == Level::Warning) ? L"WARN" :
+		(record.level == Level::Notice) ? L"NOTE" :
 		L"DBUG";
 
 	std::wstring message = levelSz;
 	message += L" (";
-	message.append(entry.timestamp);
+	message += timestampSz;
 	message += L") ";
-	message += entry.source;
+	message += record.source;
 	message += L": ";
-	message += entry.message;
+	message += record.message;
 	message += L'\n';
 
 	OutputDebugStringW (message.c_str ());
@@ -97,109 +234,96 @@ void Logger::LogInternal(Level level, ULONGLONG timestamp, const WCHAR* source,
 #endif
 }
 
-void Logger::Log(Level level, const WCHAR* source, const WCHAR* msg)
+const std::list<Logger::Entry>& Logger::GetEntries()
 {
-	struct DelayedEntry
-	{
-		Level level;
-		ULONGLONG elapsed;
-		std::wstring message;
-	};
-	static std::list<DelayedEntry> s_DelayedEntries;
-
-	static ULONGLONG s_StartTime = System::GetTickCount64();
-	ULONGLONG elapsed = System::GetTickCount64() - s_StartTime;
+	EnterCriticalSection(&m_CsLog);
 
-	if (TryEnterCriticalSection(&m_CsLog))
+	m_Entries.clear();
+	for (size_t i = 0; i < m_HistoryCount; ++i)
 	{
-		// Log queued messages first.
-		EnterCriticalSection(&m_CsLogDelay);
+		const Record& record = m_History[(m_HistoryStart + i) % MAX_LOG_ENTRIES];
 
-		while (!s_DelayedEntries.empty())
-		{
-			DelayedEntry& entry = s_DelayedEntries.front();
-			LogInternal(entry.level, entry.elapsed, source, entry.message.c_str());
+		WCHAR timestampSz[32];
+		FormatTimestamp(record.elapsed, timestampSz);
 
-			s_DelayedEntries.erase(s_DelayedEntries.begin());
-		}
+		Entry entry = {record.level, timestampSz, record.source, record.message};
+		m_Entries.push_back(entry);
+	}
 
-		LeaveCriticalSection(&m_CsLogDelay);
+	LeaveCriticalSection(&m_CsLog);
+	return m_Entries;
+}
 
-		// Log the actual message.
-		LogInternal(level, elapsed, source, msg);
+void Logger::Log(Level level, const WCHAR* source, const WCHAR* msg)
+{
+	if (!IsLevelEnabled(level)) return;
 
-		LeaveCriticalSection(&m_CsLog);
-	}
-	else
+	Push(level, [&](Record& record)
 	{
-		// Queue message.
-		EnterCriticalSection(&m_CsLogDelay);
-
-		DelayedEntry entry = {level, elapsed, msg};
-		s_DelayedEntries.push_back(entry);
-
-		LeaveCriticalSection(&m_CsLogDelay);
-	}
+		const bool truncatedSource = CopyString(record.source, source);
+		if (CopyString(record.message, msg) || truncatedSource)
+		{
+			InterlockedIncrement(&m_Truncated);
+		}
+	});
 }
 
 void Logger::LogVF(Level level, const WCHAR* source, const WCHAR* format, va_list args)
 {
-	WCHAR* buffer = new WCHAR[1024];
-
-	_invalid_parameter_handler oldHandler = _set_invalid_parameter_handler(RmNullCRTInvalidParameterHandler);
-	_CrtSetReportMode(_CRT_ASSERT, 0);
+	if (!IsLevelEnabled(level)) return;
 
-	errno = 0;
-	_vsnwprintf_s(buffer, 1024, _TRUNCATE, format, args);
-	if (errno != 0)
+	Push(level, [&](Record& record)
 	{
-		level = Level::Error;
-		_snwprintf_s(buffer, 1024, _TRUNCATE, L"Internal error: %s", format);
-	}
-
-	_set_invalid_parameter_handler(oldHandler);
+		bool truncated = CopyString(record.source, source);
 
-	Log(level, source, buffer);
-	delete [] buffer;
-}
+		_invalid_parameter_handler oldHandler = _set_invalid_parameter_handler(RmNullCRTInvalidParameterHandler);
+		_CrtSetReportMode(_CRT_ASSERT, 0);
 
-std::wstring GetSectionSourceString(Section* section)
-{
-	std::wstring source;
-	if (section)
-	{
-		MeterWindow* meterWindow = section->GetMeterWindow();
-		if (meterWindow)
+		errno = 0;
+		const int len = _vsnwprintf_s(record.message, _TRUNCATE, format, args);
+		if (errno != 0)
 		{
-			source = meterWindow->GetSkinPath();
-			source += L" - ";
+			record.level = Level::Error;
+			_snwprintf_s(record.message, _TRUNCATE, L"Internal error: %s", format);
+		}
+		else if (len < 0)
+		{
+			MarkTruncated(record.message);
+			truncated = true;
 		}
 
-		source += L'[';
-		source += section->GetOriginalName();
-		source += L']';
-	}
-	return source;
+		_set_invalid_parameter_handler(oldHandler);
+
+		if (truncated)
+		{
+			InterlockedIncrement(&m_Truncated);
+		}
+	});
 }
 
 void Logger::LogSection(Logger::Level level, Section* section, const WCHAR* message)
 {
-	const std::wstring source = GetSectionSourceString(section);
-	GetLogger().Log(level, source.c_str(), message);
+	if (!IsLevelEnabled(level)) return;
+
+	WCHAR source[MAX_SOURCE_LENGTH];
+	FormatSource(section ? section->GetMeterWindow() : nullptr, section, source);
+	Log(level, source, message);
 }
 
 void Logger::LogSectionVF(Logger::Level level, Section* section, const WCHAR* format, va_list args)
 {
-	const std::wstring source = GetSectionSourceString(section);
-	GetLogger().LogVF(level, source.c_str(), format, args);
+	if (!IsLevelEnabled(level)) return;
+
+	WCHAR source[MAX_SOURCE_LENGTH];
+	FormatSource(section ? section->GetMeterWindow() : nullptr, section, source);
+	LogVF(level, source, format, args);
 }
 
 void Logger::LogMeterWindowVF(Logger::Level level, MeterWindow* meterWindow, const WCHAR* format, va_list args)
 {
-	std::wstring source;
-	if (meterWindow)
-	{
-		source = meterWindow->GetSkinPath();
-	}
-	GetLogger().LogVF(level, source.c_str(), format, args);
+	if (!IsLevelEnabled(level)) return;
+
+	WCHAR source[MAX_SOURCE_LENGTH];
+	FormatSource(meterWindow, nullptr, source);
+	LogVF(level, source, format, args);
 }
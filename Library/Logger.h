@@ -23,6 +23,7 @@
 #include <cstdarg>
 #include <string>
 #include <list>
+#include "../Common/MPSCRing.h"
 
 class Section;
 class MeterWindow;
@@ -47,22 +48,47 @@ public:
 		std::wstring message;
 	};
 
+	static const size_t MAX_SOURCE_LENGTH = 256;
+	static const size_t MAX_MESSAGE_LENGTH = 1024;
+
 	static Logger& GetInstance();
 
 	typedef void (*LoggerCallback) (Level level, LPCWSTR timestamp, LPCWSTR source, LPCWSTR message);
 
 	void SetLogCallback(LoggerCallback callback) { m_LoggerCallback = callback; }
 
+	// Messages longer than MAX_MESSAGE_LENGTH - 1 characters (and sources longer than
+	// MAX_SOURCE_LENGTH - 1) are cut short and end with "...". The number of cut messages is
+	// logged as a warning.
 	void Log(Level level, const WCHAR* source, const WCHAR* msg);
 	void LogVF(Level level, const WCHAR* source, const WCHAR* format, va_list args);
 	void LogMeterWindowVF(Logger::Level level, MeterWindow* meterWindow, const WCHAR* format, va_list args);
 	void LogSection(Logger::Level level, Section* section, const WCHAR* message);
 	void LogSectionVF(Logger::Level level, Section* section, const WCHAR* format, va_list args);
 
-	const std::list<Entry>& GetEntries() { return m_Entries; }
+	// Returns the most recent entries. The timestamps are formatted here rather than when logging.
+	const std::list<Entry>& GetEntries();
 
 private:
-	void LogInternal(Level level, ULONGLONG timestamp, const WCHAR* source, const WCHAR* msg);
+	// A message as stored in the ring and the history. The strings are stored inline so that
+	// logging does not allocate.
+	struct Record
+	{
+		Level level;
+		ULONGLONG elapsed;
+		WCHAR source[MAX_SOURCE_LENGTH];
+		WCHAR message[MAX_MESSAGE_LENGTH];
+	};
+
+	static const size_t MAX_LOG_ENTRIES = 20;
+
+	bool IsLevelEnabled(Level level);
+
+	template <typename Fill>
+	void Push(Level level, Fill fill);
+
+	void ProcessRecords();
+	void LogInternal(const Record& record);
 
 	Logger();
 	~Logger();
@@ -73,10 +99,21 @@ private:
 	bool m_LogToFile;
 	LoggerCallback m_LoggerCallback;
 
+	ULONGLONG m_StartTime;
+
+	// Messages are pushed to the ring by any thread without locking. The thread that holds
+	// m_CsLog moves them to the history and calls the callback.
+	MPSCRing<Record, 64> m_Ring;
+	bool m_Processing;
+	volatile LONG m_Truncated;		// Messages cut short since the last ProcessRecords()
+
+	Record m_History[MAX_LOG_ENTRIES];
+	size_t m_HistoryStart;
+	size_t m_HistoryCount;
+
 	std::list<Entry> m_Entries;
 
 	CRITICAL_SECTION m_CsLog;
-	CRITICAL_SECTION m_CsLogDelay;
 };
 
 // Convenience functions.
@@ -74,10 +74,15 @@ Measure::Measure(MeterWindow* meterWindow, const WCHAR* name) : Section(meterWin
 	m_MinValue(),
 	m_MaxValue(1.0),
 	m_Value(),
+	m_SubstituteOption(),
 	m_RegExpSubstitute(false),
+	m_SubstituteCached(false),
+	m_SubstituteHits(),
+	m_SubstituteMisses(),
 	m_MedianPos(),
 	m_AveragePos(),
 	m_AverageSize(),
+	m_AverageSum(),
 	m_Disabled(false),
 	m_Paused(false),
 	m_Initialized(false),
@@ -92,6 +97,14 @@ Measure::Measure(MeterWindow* meterWindow, const WCHAR* name) : Section(meterWin
 */
 Measure::~Measure()
 {
+	if (GetRainmeter().GetDebug() && m_SubstituteMisses > 0)
+	{
+		const UINT64 total = m_SubstituteHits + m_SubstituteMisses;
+		LogDebugF(this, L"Substitute: %llu of %llu lookups cached (%.1f%%)",
+			m_SubstituteHits, total, 100.0 * m_SubstituteHits / total);
+	}
+
+	ClearSubstitute();
 	delete m_OldValue;
 }
 
@@ -115,12 +128,6 @@ void Measure::ReadOptions(ConfigParser& parser, const WCHAR* section)
 
 	Section::ReadOptions(parser, section);
 
-	// Clear substitutes to prevent from being added more than once.
-	if (!m_Substitute.empty())
-	{
-		m_Substitute.clear();
-	}
-
 	m_Invert = parser.ReadBool(section, L"InvertMeasure", false);
 
 	m_Disabled = parser.ReadBool(section, L"Disabled", false);
@@ -142,20 +149,36 @@ void Measure::ReadOptions(ConfigParser& parser, const WCHAR* section)
 
 	m_AverageSize = parser.ReadUInt(section, L"AverageSize", 0);
 
-	m_RegExpSubstitute = parser.ReadBool(section, L"RegExpSubstitute", false);
+	// Substitutes are parsed and compiled again only if they have changed (e.g. not on every
+	// DynamicVariables reread).
+	const bool regExpSubstitute = parser.ReadBool(section, L"RegExpSubstitute", false);
 	std::wstring subs = parser.ReadString(section, L"Substitute", L"");
-	if (!subs.empty())
+	if (regExpSubstitute != m_RegExpSubstitute || subs != m_SubstituteOption)
 	{
-		if ((subs[0] != L'"' || subs[subs.length() - 1] != L'\'') &&
-			(subs[0] != L'\'' || subs[subs.length() - 1] != L'"'))
-		{
-			// Add quotes since they are removed by the GetProfileString
-			subs.insert(0, 1, L'"');
-			subs += L'"';
-		}
-		if (!ParseSubstitute(subs))
+		// Clear substitutes to prevent from being added more than once.
+		ClearSubstitute();
+
+		m_RegExpSubstitute = regExpSubstitute;
+		m_SubstituteOption = subs;
+
+		if (!subs.empty())
 		{
-			LogErrorF(this, L"Measure: Invalid Substitute=%s", subs.c_str());
+			if ((subs[0] != L'"' || subs[subs.length() - 1] != L'\'') &&
+				(subs[0] != L'\'' || subs[subs.length() - 1] != L'"'))
+			{
+				// Add quotes since they are removed by the GetProfileString
+				subs.insert(0, 1, L'"');
+				subs += L'"';
+			}
+			if (!ParseSubstitute(subs))
+			{
+				LogErrorF(this, L"Measure: Invalid Substitute=%s", subs.c_str());
+			}
+
+			if (m_RegExpSubstitute)
+			{
+				CompileSubstitute();
+			}
 		}
 	}
 
@@ -224,13 +247,22 @@ bool Measure::MakePlainSubstitute(std::wstring& str, size_t index)
 */
 const WCHAR* Measure::CheckSubstitute(const WCHAR* buffer)
 {
-	static std::wstring str;
-
 	if (m_Substitute.empty())
 	{
 		return buffer;
 	}
 
+	if (m_SubstituteCached && wcscmp(buffer, m_SubstituteInput.c_str()) == 0)
+	{
+		++m_SubstituteHits;
+		return m_SubstituteOutput.c_str();
+	}
+
+	++m_SubstituteMisses;
+	m_SubstituteInput = buffer;
+	m_SubstituteCached = true;
+
+	std::wstring& str = m_SubstituteOutput;
 	if (!m_RegExpSubstitute)
 	{
 		str = buffer;
@@ -253,29 +285,16 @@ const WCHAR* Measure::CheckSubstitute(const WCHAR* buffer)
 		std::string utf8str = StringUtil::NarrowUTF8(buffer);
 		int ovector[300];
 
-		for (size_t i = 0, isize = m_Substitute.size(); i < isize; i += 2)
+		for (const auto& substitute : m_SubstituteRegExps)
 		{
-			const char* error;
-			int errorOffset;
 			int offset = 0;
-			pcre* re = pcre_compile(
-				StringUtil::NarrowUTF8(m_Substitute[i]).c_str(),
-				PCRE_UTF8,
-				&error,
-				&errorOffset,
-				nullptr);  // Use default character tables.
-			if (!re)
-			{
-				MakePlainSubstitute(str, i);
-				LogNoticeF(this, L"Substitute: %S", error);
-			}
-			else
+			if (substitute.re)
 			{
 				do
 				{
 					const int rc = pcre_exec(
-						re,
-						nullptr,           // No extra data - we didn't study the pattern
+						substitute.re,
+						substitute.extra,
 						utf8str.c_str(),   // The subject string
 						(int)utf8str.length(),  // The length of the subject
 						offset,
@@ -287,7 +306,7 @@ const WCHAR* Measure::CheckSubstitute(const WCHAR* buffer)
 						break;
 					}
 
-					std::string result = StringUtil::NarrowUTF8(m_Substitute[i + 1]);
+					std::string result = substitute.replacement;
 
 					if (rc > 1)
 					{
@@ -318,8 +337,6 @@ const WCHAR* Measure::CheckSubstitute(const WCHAR* buffer)
 					offset = start + (int)result.length();
 				}
 				while (true);
-
-				pcre_free(re);
 			}
 		}
 
@@ -329,6 +346,54 @@ const WCHAR* Measure::CheckSubstitute(const WCHAR* buffer)
 	return str.c_str();
 }
 
+/*
+** Compiles and studies the RegExpSubstitute patterns in m_Substitute.
+**
+*/
+void Measure::CompileSubstitute()
+{
+	for (size_t i = 0, isize = m_Substitute.size(); i < isize; i += 2)
+	{
+		SubstituteRegExp substitute = { nullptr, nullptr, StringUtil::NarrowUTF8(m_Substitute[i + 1]) };
+
+		const char* error;
+		int errorOffset;
+		substitute.re = pcre_compile(
+			StringUtil::NarrowUTF8(m_Substitute[i]).c_str(),
+			PCRE_UTF8,
+			&error,
+			&errorOffset,
+			nullptr);  // Use default character tables.
+		if (substitute.re)
+		{
+			// Returns nullptr without error if studying would not help.
+			substitute.extra = pcre_study(substitute.re, 0, &error);
+		}
+		else
+		{
+			LogNoticeF(this, L"Substitute: %S", error);
+		}
+
+		m_SubstituteRegExps.push_back(std::move(substitute));
+	}
+}
+
+void Measure::ClearSubstitute()
+{
+	for (const auto& substitute : m_SubstituteRegExps)
+	{
+		if (substitute.extra) pcre_free(substitute.extra);
+		if (substitute.re) pcre_free(substitute.re);
+	}
+
+	m_SubstituteRegExps.clear();
+	m_Substitute.clear();
+
+	m_SubstituteCached = false;
+	m_SubstituteInput.clear();
+	m_SubstituteOutput.clear();
+}
+
 /*
 ** Reads the buffer for "Name":"Value"-pairs separated with comma and
 ** fills the map with the parsed data.
@@ -434,7 +499,14 @@ bool Measure::Update(bool rereadOptions)
 {
 	if (rereadOptions)
 	{
-		ReadOptions(m_MeterWindow->GetParser());
+		// Skip reading the options if none of the variables and measures they use has changed.
+		ConfigParser& parser = m_MeterWindow->GetParser();
+		if (parser.HaveDependenciesChanged(m_OptionDependencies))
+		{
+			parser.BeginDependencies(m_OptionDependencies);
+			ReadOptions(parser);
+			parser.EndDependencies();
+		}
 	}
 
 	// Don't do anything if paused
@@ -452,24 +524,32 @@ bool Measure::Update(bool rereadOptions)
 		{
 			size_t averageValuesSize = m_AverageValues.size();
 
+			bool resum = false;
 			if (m_AverageSize != averageValuesSize)
 			{
 				m_AverageValues.resize(m_AverageSize, m_Value);
 				averageValuesSize = m_AverageValues.size();
 				if (m_AveragePos >= averageValuesSize) m_AveragePos = 0;
+				resum = true;
 			}
+
+			m_AverageSum += m_Value - m_AverageValues[m_AveragePos];
 			m_AverageValues[m_AveragePos] = m_Value;
 
 			++m_AveragePos;
 			m_AveragePos %= averageValuesSize;
 
-			// Calculate the average value
-			double value = 0;
-			for (size_t i = 0; i < averageValuesSize; ++i)
+			// Recalculate the sum once per cycle to avoid accumulating rounding errors.
+			if (resum || m_AveragePos == 0)
 			{
-				value += m_AverageValues[i];
+				m_AverageSum = 0.0;
+				for (size_t i = 0; i < averageValuesSize; ++i)
+				{
+					m_AverageSum += m_AverageValues[i];
+				}
 			}
-			m_Value = value / (double)averageValuesSize;
+
+			m_Value = m_AverageSum / (double)averageValuesSize;
 		}
 
 		// If we're logging the maximum value of the measure, check if
@@ -485,10 +565,12 @@ bool Measure::Update(bool rereadOptions)
 			++m_MedianPos;
 			m_MedianPos %= MEDIAN_SIZE;
 
-			auto medianArray = m_MedianValues;
-			std::sort(&medianArray.data()[0], &medianArray.data()[MEDIAN_SIZE]);  // Workaround for "Debug" build mode
-
-			double medianValue = medianArray[MEDIAN_SIZE / 2];
+			// Median of three without copying and sorting the array.
+			static_assert(MEDIAN_SIZE == 3, "Median calculation assumes three values");
+			const double a = m_MedianValues[0];
+			const double b = m_MedianValues[1];
+			const double c = m_MedianValues[2];
+			double medianValue = max(min(a, b), min(max(a, b), c));
 			m_MaxValue = max(m_MaxValue, medianValue);
 			m_MinValue = min(m_MinValue, medianValue);
 		}
@@ -499,7 +581,13 @@ bool Measure::Update(bool rereadOptions)
 		// [MeasureName], we need to read the options after m_Value has been changed.
 		if (rereadOptions)
 		{
-			m_IfActions.ReadConditionOptions(m_MeterWindow->GetParser(), GetName());
+			ConfigParser& parser = m_MeterWindow->GetParser();
+			if (parser.HaveDependenciesChanged(m_ConditionDependencies))
+			{
+				parser.BeginDependencies(m_ConditionDependencies);
+				m_IfActions.ReadConditionOptions(parser, GetName());
+				parser.EndDependencies();
+			}
 		}
 
 		if (m_MeterWindow)
@@ -814,25 +902,3 @@ void Measure::Command(const std::wstring& command)
 {
 	LogWarningF(this, L"!CommandMeasure: Not supported");
 }
-
-/*
-** Returns the number value of a measure, used by IfCondition's.
-**
-*/
-bool Measure::GetCurrentMeasureValue(const WCHAR* str, int len, double* value, void* context)
-{
-	auto measure = (Measure*)context;
-	const std::vector<Measure*>& measures = measure->m_MeterWindow->GetMeasures();
-
-	for (const auto& iter : measures)
-	{
-		if (iter->GetOriginalName().length() == len &&
-			_wcsnicmp(str, iter->GetName(), len) == 0)
-		{
-			*value = iter->GetValue();
-			return true;
-		}
-	}
-
-	return false;
-}
@@ -52,6 +52,8 @@ private:
 class Meter;
 class MeterWindow;
 class ConfigParser;
+struct real_pcre;
+struct pcre_extra;
 
 class __declspec(novtable) Measure : public Section
 {
@@ -92,7 +94,6 @@ public:
 	void DoChangeAction(bool execute = true);
 
 	static Measure* Create(const WCHAR* measure, MeterWindow* meterWindow, const WCHAR* name);
-	static bool GetCurrentMeasureValue(const WCHAR* str, int len, double* value, void* context);
 
 protected:
 	Measure(MeterWindow* meterWindow, const WCHAR* name);
@@ -101,6 +102,8 @@ protected:
 	virtual void UpdateValue() = 0;
 
 	bool ParseSubstitute(std::wstring buffer);
+	void CompileSubstitute();
+	void ClearSubstitute();
 	std::wstring ExtractWord(std::wstring& buffer);
 	const WCHAR* CheckSubstitute(const WCHAR* buffer);
 	bool MakePlainSubstitute(std::wstring& str, size_t index);
@@ -111,17 +114,38 @@ protected:
 	double m_MaxValue;				// The maximum value (so far)
 	double m_Value;					// The current value
 
+	std::wstring m_SubstituteOption;		// Substitute as read, to detect changes on reread
 	std::vector<std::wstring> m_Substitute;	// Vec of substitute strings
 	bool m_RegExpSubstitute;
 
+	// Compiled m_Substitute pattern/replacement pairs when m_RegExpSubstitute is set. Compiled once
+	// in ReadOptions() as compiling and converting to UTF-8 on every update is expensive.
+	struct SubstituteRegExp
+	{
+		real_pcre* re;				// nullptr if the pattern is invalid
+		pcre_extra* extra;
+		std::string replacement;	// UTF-8
+	};
+	std::vector<SubstituteRegExp> m_SubstituteRegExps;
+
+	// Last CheckSubstitute() input and its result. Most string values do not change between
+	// updates, so the substitutes are applied only when the input changes.
+	std::wstring m_SubstituteInput;
+	std::wstring m_SubstituteOutput;
+	bool m_SubstituteCached;
+	UINT64 m_SubstituteHits;
+	UINT64 m_SubstituteMisses;
+
 	std::vector<double> m_MedianValues;	// The values for the median filtering
 	UINT m_MedianPos;				// Position in the median array, where the new value is placed
 
 	std::vector<double> m_AverageValues;
 	UINT m_AveragePos;
 	UINT m_AverageSize;
+	double m_AverageSum;			// Running sum of m_AverageValues
 
 	IfActions m_IfActions;
+	ConfigParser::Dependencies m_ConditionDependencies;	// Inputs of the last ReadConditionOptions()
 	bool m_Disabled;				// Status of the measure
 	bool m_Paused;
 	bool m_Initialized;
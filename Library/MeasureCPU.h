@@ -21,8 +21,6 @@
 
 #include "Measure.h"
 
-typedef LONG (WINAPI *FPNTQSI)(UINT, PVOID, ULONG, PULONG);
-
 class MeasureCPU : public Measure
 {
 public:
@@ -34,9 +32,6 @@ public:
 
 	virtual UINT GetTypeID() { return TypeID<MeasureCPU>(); }
 
-	static void InitializeStatic();
-	static void FinalizeStatic();
-
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 	virtual void UpdateValue();
@@ -47,11 +42,7 @@ private:
 	int m_Processor;
 
 	double m_OldTime[2];
-
-	static FPNTQSI c_NtQuerySystemInformation;
-
-	static int c_NumOfProcessors;
-	static ULONG c_BufferSize;
+	ULONGLONG m_Generation;		// Generation of the processor times in m_OldTime
 };
 
 #endif
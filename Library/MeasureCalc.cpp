@@ -17,7 +17,6 @@
 */
 
 #include "StdAfx.h"
-#include "../Common/MathParser.h"
 #include "MeasureCalc.h"
 #include "Rainmeter.h"
 #include <random>
@@ -59,7 +58,12 @@ MeasureCalc::~MeasureCalc()
 */
 void MeasureCalc::UpdateValue()
 {
-	const WCHAR* errMsg = MathParser::Parse(m_Formula.c_str(), &m_Value, GetMeasureValue, this);
+	if (!m_Binding.IsBound())
+	{
+		m_Binding.Bind(m_Program, m_MeterWindow);
+	}
+
+	const WCHAR* errMsg = MathParser::EvaluateIndexed(m_Program, &m_Value, GetMeasureValue, this);
 	if (errMsg != nullptr)
 	{
 		if (!m_ParseError)
@@ -124,26 +128,40 @@ void MeasureCalc::ReadOptions(ConfigParser& parser, const WCHAR* section)
 			UpdateUniqueNumberList();
 		}
 
-		if (!m_UpdateRandom)
+		if (!m_UpdateRandom && FormulaReplace())
 		{
-			FormulaReplace();
+			// A new random number is picked each time the options are read, so DynamicVariables
+			// rereads cannot be skipped.
+			parser.AddUntrackedDependency();
 		}
 
 		const WCHAR* errMsg = MathParser::Check(m_Formula.c_str());
+		if (errMsg == nullptr)
+		{
+			// Compile once here so that UpdateValue() only needs to evaluate the program.
+			errMsg = MathParser::Compile(m_Formula.c_str(), m_Program);
+		}
+
+		// Measures are bound on next update.
+		m_Binding.Reset();
+
 		if (errMsg != nullptr)
 		{
 			LogErrorF(this, L"Calc: %s", errMsg);
 			m_Formula.clear();
+			m_Program.Clear();
 		}
 	}
 }
 
 /*
-** This replaces the word Random in the formula with a random number
+** This replaces the word Random in the formula with a random number. Returns true if the formula
+** contained Random.
 **
 */
-void MeasureCalc::FormulaReplace()
+bool MeasureCalc::FormulaReplace()
 {
+	bool replaced = false;
 	size_t start = 0, pos;
 	do
 	{
@@ -162,6 +180,7 @@ void MeasureCalc::FormulaReplace()
 
 				m_Formula.replace(pos, 6, buffer, len);
 				start = pos + len;
+				replaced = true;
 			}
 			else
 			{
@@ -170,30 +189,26 @@ void MeasureCalc::FormulaReplace()
 		}
 	}
 	while (pos != std::wstring::npos);
+
+	return replaced;
 }
 
-bool MeasureCalc::GetMeasureValue(const WCHAR* str, int len, double* value, void* context)
+bool MeasureCalc::GetMeasureValue(size_t index, double* value, void* context)
 {
 	auto calc = (MeasureCalc*)context;
-	const std::vector<Measure*>& measures = calc->m_MeterWindow->GetMeasures();
-
-	std::vector<Measure*>::const_iterator iter = measures.begin();
-	for ( ; iter != measures.end(); ++iter)
+	if (FormulaBinding::GetMeasureValue(index, value, &calc->m_Binding))
 	{
-		if ((*iter)->GetOriginalName().length() == len &&
-			_wcsnicmp(str, (*iter)->GetName(), len) == 0)
-		{
-			*value = (*iter)->GetValue();
-			return true;
-		}
+		return true;
 	}
 
-	if (_wcsnicmp(str, L"counter", len) == 0)
+	const std::wstring& name = calc->m_Program.GetName(index);
+	const size_t len = name.length();
+	if (_wcsnicmp(name.c_str(), L"counter", len) == 0)
 	{
 		*value = calc->m_MeterWindow->GetUpdateCounter();
 		return true;
 	}
-	else if (_wcsnicmp(str, L"random", len) == 0)
+	else if (_wcsnicmp(name.c_str(), L"random", len) == 0)
 	{
 		*value = calc->GetRandom();
 		return true;
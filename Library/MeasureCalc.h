@@ -20,6 +20,7 @@
 #define __MEASURECALC_H__
 
 #include "Measure.h"
+#include "FormulaBinding.h"
 
 class MeasureCalc : public Measure
 {
@@ -37,12 +38,14 @@ protected:
 	virtual void UpdateValue();
 
 private:
-	static bool GetMeasureValue(const WCHAR* str, int len, double* value, void* context);
+	static bool GetMeasureValue(size_t index, double* value, void* context);
 
-	void FormulaReplace();
+	bool FormulaReplace();
 	int GetRandom();
 
 	std::wstring m_Formula;
+	MathParser::Program m_Program;
+	FormulaBinding m_Binding;
 	bool m_ParseError;
 
 	int m_LowBound;
@@ -20,6 +20,7 @@
 #include "MeasureDiskSpace.h"
 #include "Rainmeter.h"
 #include "System.h"
+#include "SystemMetrics.h"
 #include "../Common/PathUtil.h"
 
 enum DRIVETYPE
@@ -66,11 +67,10 @@ void MeasureDiskSpace::UpdateValue()
 	if (!m_Drive.empty())
 	{
 		const WCHAR* drive = m_Drive.c_str();
-		UINT type = GetDriveType(drive);
 
 		if (m_Type)
 		{
-			switch (type)
+			switch (GetDriveType(drive))
 			{
 			case DRIVE_UNKNOWN:
 			case DRIVE_NO_ROOT_DIR:
@@ -105,32 +105,18 @@ void MeasureDiskSpace::UpdateValue()
 		}
 		else
 		{
-			BOOL sizeResult = FALSE;
-			ULONGLONG i64TotalBytes, i64FreeBytes;
+			const DiskSpace& space = SystemMetrics::GetDiskSpace(m_Drive, m_DiskQuota, m_IgnoreRemovable);
+			const UINT type = space.type;
 
-			if (type != DRIVE_NO_ROOT_DIR &&
-				type != DRIVE_CDROM &&
-				(!m_IgnoreRemovable || type != DRIVE_REMOVABLE))  // Ignore CD-ROMS and removable drives
-			{
-				if (!m_DiskQuota)
-				{
-					sizeResult = GetDiskFreeSpaceEx(drive, nullptr, (PULARGE_INTEGER)&i64TotalBytes, (PULARGE_INTEGER)&i64FreeBytes);
-				}
-				else
-				{
-					sizeResult = GetDiskFreeSpaceEx(drive, (PULARGE_INTEGER)&i64FreeBytes, (PULARGE_INTEGER)&i64TotalBytes, nullptr);
-				}
-			}
-
-			if (sizeResult)
+			if (space.hasSize)
 			{
-				m_Value = (double)(__int64)((m_Total) ? i64TotalBytes : i64FreeBytes);
+				m_Value = (double)(__int64)((m_Total) ? space.totalBytes : space.freeBytes);
 
-				if (i64TotalBytes != m_OldTotalBytes)
+				if (space.totalBytes != m_OldTotalBytes)
 				{
 					// Total size was changed, so set new max value.
-					m_MaxValue = (double)(__int64)i64TotalBytes;
-					m_OldTotalBytes = i64TotalBytes;
+					m_MaxValue = (double)(__int64)space.totalBytes;
+					m_OldTotalBytes = space.totalBytes;
 				}
 			}
 			else
@@ -19,6 +19,7 @@
 #include "StdAfx.h"
 #include "MeasureMemory.h"
 #include "ConfigParser.h"
+#include "SystemMetrics.h"
 
 /*
 ** The constructor
@@ -27,9 +28,7 @@
 MeasureMemory::MeasureMemory(MeterWindow* meterWindow, const WCHAR* name) : Measure(meterWindow, name),
 	m_Total(false)
 {
-	MEMORYSTATUSEX stat;
-	stat.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&stat);
+	const MEMORYSTATUSEX& stat = SystemMetrics::GetMemoryStatus();
 	m_MaxValue = (double)(__int64)(stat.ullTotalPageFile + stat.ullTotalPhys);
 }
 
@@ -47,9 +46,7 @@ MeasureMemory::~MeasureMemory()
 */
 void MeasureMemory::UpdateValue()
 {
-	MEMORYSTATUSEX stat;
-	stat.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&stat);
+	const MEMORYSTATUSEX& stat = SystemMetrics::GetMemoryStatus();
 	m_MaxValue = (double)(__int64)(stat.ullTotalPageFile + stat.ullTotalPhys);
 
 	if (m_Total)
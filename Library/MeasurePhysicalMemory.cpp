@@ -19,6 +19,7 @@
 #include "StdAfx.h"
 #include "MeasurePhysicalMemory.h"
 #include "ConfigParser.h"
+#include "SystemMetrics.h"
 
 /*
 ** The constructor
@@ -27,9 +28,7 @@
 MeasurePhysicalMemory::MeasurePhysicalMemory(MeterWindow* meterWindow, const WCHAR* name) : Measure(meterWindow, name),
 	m_Total(false)
 {
-	MEMORYSTATUSEX stat;
-	stat.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&stat);
+	const MEMORYSTATUSEX& stat = SystemMetrics::GetMemoryStatus();
 	m_MaxValue = (double)(__int64)stat.ullTotalPhys;
 }
 
@@ -49,9 +48,7 @@ void MeasurePhysicalMemory::UpdateValue()
 {
 	if (!m_Total)
 	{
-		MEMORYSTATUSEX stat;
-		stat.dwLength = sizeof(MEMORYSTATUSEX);
-		GlobalMemoryStatusEx(&stat);
+		const MEMORYSTATUSEX& stat = SystemMetrics::GetMemoryStatus();
 
 		m_Value = (double)(__int64)(stat.ullTotalPhys - stat.ullAvailPhys);
 	}
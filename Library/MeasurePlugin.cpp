@@ -23,19 +23,36 @@
 #include "System.h"
 #include "Error.h"
 
+namespace {
+
+// Set while a thread pool thread is running an asynchronous update.
+const DWORD s_UpdateThreadTls = TlsAlloc();
+
+}  // namespace
+
+std::unordered_map<HMODULE, MeasurePlugin::ModuleLock*> MeasurePlugin::c_ModuleLocks;
+
 /*
 ** The constructor
 **
 */
 MeasurePlugin::MeasurePlugin(MeterWindow* meterWindow, const WCHAR* name) : Measure(meterWindow, name),
 	m_Plugin(),
+	m_ModuleLock(),
 	m_ReloadFunc(),
 	m_ID(),
 	m_Update2(false),
 	m_PluginData(),
 	m_UpdateFunc(),
 	m_GetStringFunc(),
-	m_ExecuteBangFunc()
+	m_ExecuteBangFunc(),
+	m_UpdateAsync(false),
+	m_UpdateBusy(0),
+	m_AsyncValue(),
+	m_AsyncHasString(false),
+	m_AsyncCallErrorLogged(false),
+	m_HasStringValue(false),
+	m_ReloadPending(false)
 {
 }
 
@@ -45,11 +62,14 @@ MeasurePlugin::MeasurePlugin(MeterWindow* meterWindow, const WCHAR* name) : Meas
 */
 MeasurePlugin::~MeasurePlugin()
 {
+	WaitForUpdate();
+
 	if (m_Plugin)
 	{
 		FARPROC finalizeFunc = GetProcAddress(m_Plugin, "Finalize");
 		if (finalizeFunc)
 		{
+			EnterModule();
 			if (IsNewApi())
 			{
 				((NEWFINALIZE)finalizeFunc)(m_PluginData);
@@ -58,41 +78,262 @@ MeasurePlugin::~MeasurePlugin()
 			{
 				((FINALIZE)finalizeFunc)(m_Plugin, m_ID);
 			}
+			LeaveModule();
 		}
 
 		FreeLibrary(m_Plugin);
+		ReleaseModuleLock();
+	}
+}
+
+/*
+** Returns true if called from Update or GetString of a plugin with UpdateAsync=1.
+**
+*/
+bool MeasurePlugin::IsAsyncUpdateThread()
+{
+	return TlsGetValue(s_UpdateThreadTls) != nullptr;
+}
+
+/*
+** Logs the use of a function that can't be called during an asynchronous update. Called only
+** from the thread pool.
+**
+*/
+void MeasurePlugin::LogAsyncCallError(const WCHAR* function)
+{
+	if (!m_AsyncCallErrorLogged)
+	{
+		m_AsyncCallErrorLogged = true;
+		LogErrorF(this, L"Plugin: %s cannot be used in Update or GetString with UpdateAsync=1", function);
 	}
 }
 
+/*
+** Gets (or creates) the lock of the loaded plugin module.
+**
+*/
+void MeasurePlugin::AcquireModuleLock()
+{
+	ModuleLock*& lock = c_ModuleLocks[m_Plugin];
+	if (!lock)
+	{
+		lock = new ModuleLock;
+		System::InitializeCriticalSection(&lock->cs);
+		lock->refCount = 0;
+	}
+
+	++lock->refCount;
+	m_ModuleLock = lock;
+}
+
+/*
+** Releases the lock of the plugin module. The lock is deleted along with the last measure
+** using the module.
+**
+*/
+void MeasurePlugin::ReleaseModuleLock()
+{
+	if (m_ModuleLock && --m_ModuleLock->refCount == 0)
+	{
+		DeleteCriticalSection(&m_ModuleLock->cs);
+		delete m_ModuleLock;
+		c_ModuleLocks.erase(m_Plugin);
+	}
+
+	m_ModuleLock = nullptr;
+}
+
+/*
+** Enters the lock of the plugin module. Sent messages are processed while waiting on the UI
+** thread (see WaitForUpdate).
+**
+*/
+void MeasurePlugin::EnterModule()
+{
+	if (IsAsyncUpdateThread())
+	{
+		EnterCriticalSection(&m_ModuleLock->cs);
+		return;
+	}
+
+	while (!TryEnterCriticalSection(&m_ModuleLock->cs))
+	{
+		MsgWaitForMultipleObjects(0, nullptr, FALSE, 10, QS_SENDMESSAGE);
+
+		MSG msg;
+		PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE | PM_QS_SENDMESSAGE);
+	}
+}
+
+bool MeasurePlugin::TryEnterModule()
+{
+	return TryEnterCriticalSection(&m_ModuleLock->cs) != FALSE;
+}
+
+void MeasurePlugin::LeaveModule()
+{
+	LeaveCriticalSection(&m_ModuleLock->cs);
+}
+
+/*
+** Calls the Reload function of the plugin. The module lock must be held.
+**
+*/
+void MeasurePlugin::Reload()
+{
+	m_ReloadPending = false;
+	((NEWRELOAD)m_ReloadFunc)(m_PluginData, this, &m_MaxValue);
+
+	// Reset to default
+	System::ResetWorkingDirectory();
+}
+
 /*
 ** Gets the current value from the plugin
 **
 */
 void MeasurePlugin::UpdateValue()
 {
-	if (m_UpdateFunc)
+	if (!m_UpdateFunc) return;
+
+	if (m_UpdateAsync)
 	{
-		if (IsNewApi())
+		// Skip this update if the previous one is still running.
+		if (InterlockedCompareExchange(&m_UpdateBusy, 0, 0) != 0) return;
+
+		// Publish the result of the last completed update.
+		m_Value = m_AsyncValue;
+		m_HasStringValue = m_AsyncHasString;
+		if (m_HasStringValue)
 		{
-			m_Value = ((NEWUPDATE)m_UpdateFunc)(m_PluginData);
+			m_StringValue.swap(m_AsyncString);
 		}
-		else
+
+		// The plugin may have changed the working directory on the thread pool.
+		System::ResetWorkingDirectory();
+
+		if (m_ReloadPending)
 		{
-			if (m_Update2)
-			{
-				m_Value = ((UPDATE2)m_UpdateFunc)(m_ID);
-			}
-			else
-			{
-				m_Value = ((UPDATE)m_UpdateFunc)(m_ID);
-			}
+			// Don't block the UI if another measure is using the plugin.
+			if (!TryEnterModule()) return;
+
+			Reload();
+			LeaveModule();
+		}
+
+		InterlockedExchange(&m_UpdateBusy, 1);
+		if (!QueueUserWorkItem(UpdateThreadProc, this, WT_EXECUTEDEFAULT))
+		{
+			UpdateThreadProc(this);
+		}
+	}
+	else
+	{
+		WaitForUpdate();
+
+		EnterModule();
+		if (m_ReloadPending)
+		{
+			Reload();
 		}
+		m_Value = CallUpdate();
+		LeaveModule();
 
 		// Reset to default
 		System::ResetWorkingDirectory();
 	}
 }
 
+/*
+** Calls the Update function of the plugin.
+**
+*/
+double MeasurePlugin::CallUpdate()
+{
+	if (IsNewApi())
+	{
+		return ((NEWUPDATE)m_UpdateFunc)(m_PluginData);
+	}
+	else
+	{
+		if (m_Update2)
+		{
+			return ((UPDATE2)m_UpdateFunc)(m_ID);
+		}
+		else
+		{
+			return ((UPDATE)m_UpdateFunc)(m_ID);
+		}
+	}
+}
+
+/*
+** Calls the GetString function of the plugin.
+**
+*/
+const WCHAR* MeasurePlugin::CallGetString()
+{
+	if (IsNewApi())
+	{
+		return ((NEWGETSTRING)m_GetStringFunc)(m_PluginData);
+	}
+	else
+	{
+		return ((GETSTRING)m_GetStringFunc)(m_ID, 0);
+	}
+}
+
+/*
+** Updates the plugin on the system thread pool. The string value is read here as well so that
+** the plugin is never called from two threads at the same time. The working directory is reset
+** on the UI thread when the result is published.
+**
+*/
+DWORD WINAPI MeasurePlugin::UpdateThreadProc(void* param)
+{
+	MeasurePlugin* measure = (MeasurePlugin*)param;
+
+	TlsSetValue(s_UpdateThreadTls, measure);
+	measure->EnterModule();
+
+	measure->m_AsyncValue = measure->CallUpdate();
+
+	measure->m_AsyncHasString = false;
+	if (measure->m_GetStringFunc)
+	{
+		const WCHAR* ret = measure->CallGetString();
+		if (ret)
+		{
+			measure->m_AsyncString = ret;
+			measure->m_AsyncHasString = true;
+		}
+	}
+
+	measure->LeaveModule();
+	TlsSetValue(s_UpdateThreadTls, nullptr);
+
+	// The measure may be deleted as soon as this is cleared.
+	InterlockedExchange(&measure->m_UpdateBusy, 0);
+	return 0;
+}
+
+/*
+** Waits for the update running on the thread pool to finish. Sent messages are processed while
+** waiting because the plugin may call RmExecute (which uses SendMessage) from Update.
+**
+*/
+void MeasurePlugin::WaitForUpdate()
+{
+	while (InterlockedCompareExchange(&m_UpdateBusy, 0, 0) != 0)
+	{
+		MsgWaitForMultipleObjects(0, nullptr, FALSE, 10, QS_SENDMESSAGE);
+
+		MSG msg;
+		PeekMessage(&msg, nullptr, 0, 0, PM_NOREMOVE | PM_QS_SENDMESSAGE);
+	}
+}
+
 /*
 ** Reads the options and loads the plugin
 **
@@ -103,11 +344,35 @@ void MeasurePlugin::ReadOptions(ConfigParser& parser, const WCHAR* section)
 
 	Measure::ReadOptions(parser, section);
 
+	// The options are read on every update with DynamicVariables=1 so don't wait for the plugin
+	// here. Reload is deferred to UpdateValue if the plugin is busy.
+	const bool updateBusy = InterlockedCompareExchange(&m_UpdateBusy, 0, 0) != 0;
+	const bool updateAsync = parser.ReadBool(section, L"UpdateAsync", false);
+	if (updateAsync && !m_UpdateAsync && !updateBusy)
+	{
+		// Nothing has completed on the thread pool yet so keep the current value.
+		m_AsyncValue = m_Value;
+		m_AsyncHasString = false;
+	}
+	m_UpdateAsync = updateAsync;
+
 	if (m_Initialized)
 	{
 		if (IsNewApi())
 		{
-			((NEWRELOAD)m_ReloadFunc)(m_PluginData, this, &m_MaxValue);
+			if (!updateBusy && TryEnterModule())
+			{
+				Reload();
+				LeaveModule();
+			}
+			else
+			{
+				m_ReloadPending = true;
+
+				// The options read by the deferred Reload aren't recorded so read them again
+				// on the next update.
+				parser.AddUntrackedDependency();
+			}
 		}
 		
 		// DynamicVariables doesn't work with old plugins
@@ -157,6 +422,9 @@ void MeasurePlugin::ReadOptions(ConfigParser& parser, const WCHAR* section)
 	// Remove current directory from DLL search path
 	SetDllDirectory(L"");
 
+	AcquireModuleLock();
+	EnterModule();
+
 	double maxValue = 0.0;
 
 	if (IsNewApi())
@@ -186,6 +454,8 @@ void MeasurePlugin::ReadOptions(ConfigParser& parser, const WCHAR* section)
 		}
 	}
 
+	LeaveModule();
+
 	const std::wstring& szMaxValue = parser.ReadString(section, L"MaxValue", L"");
 	if (szMaxValue.empty())
 	{
@@ -217,17 +487,23 @@ const WCHAR* MeasurePlugin::GetStringValue()
 {
 	if (m_GetStringFunc)
 	{
-		const WCHAR* ret;
-		if (IsNewApi())
+		if (m_UpdateAsync)
 		{
-			ret = ((NEWGETSTRING)m_GetStringFunc)(m_PluginData);
+			// Updated in UpdateValue with the result of the last completed update.
+			return m_HasStringValue ? CheckSubstitute(m_StringValue.c_str()) : nullptr;
 		}
-		else
+
+		// The returned buffer may be reused by the plugin as soon as the lock is released.
+		EnterModule();
+		const WCHAR* ret = CallGetString();
+		m_HasStringValue = ret != nullptr;
+		if (ret)
 		{
-			ret = ((GETSTRING)m_GetStringFunc)(m_ID, 0);
+			m_StringValue = ret;
 		}
+		LeaveModule();
 
-		if (ret) return CheckSubstitute(ret);
+		if (m_HasStringValue) return CheckSubstitute(m_StringValue.c_str());
 	}
 
 	return nullptr;
@@ -242,6 +518,7 @@ void MeasurePlugin::Command(const std::wstring& command)
 	if (m_ExecuteBangFunc)
 	{
 		const WCHAR* str = command.c_str();
+		EnterModule();
 		if (IsNewApi())
 		{
 			((NEWEXECUTEBANG)m_ExecuteBangFunc)(m_PluginData, str);
@@ -250,6 +527,7 @@ void MeasurePlugin::Command(const std::wstring& command)
 		{
 			((EXECUTEBANG)m_ExecuteBangFunc)(str, m_ID);
 		}
+		LeaveModule();
 	}
 	else
 	{
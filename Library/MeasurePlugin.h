@@ -19,6 +19,7 @@
 #ifndef __MEASUREPLUGIN_H__
 #define __MEASUREPLUGIN_H__
 
+#include <unordered_map>
 #include "Measure.h"
 #include "Export.h"
 
@@ -50,6 +51,9 @@ public:
 	virtual const WCHAR* GetStringValue();
 	virtual void Command(const std::wstring& command);
 
+	static bool IsAsyncUpdateThread();
+	void LogAsyncCallError(const WCHAR* function);
+
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 	virtual void UpdateValue();
@@ -57,7 +61,33 @@ protected:
 private:
 	bool IsNewApi() { return m_ReloadFunc != nullptr; }
 
+	double CallUpdate();
+	const WCHAR* CallGetString();
+
+	void WaitForUpdate();
+	static DWORD WINAPI UpdateThreadProc(void* param);
+
+	// All calls into a plugin module (from any measure using it and from any thread) are made
+	// while holding its lock so that plugins written for a single thread are never run on two
+	// threads at once.
+	struct ModuleLock
+	{
+		CRITICAL_SECTION cs;
+		UINT refCount;
+	};
+
+	void AcquireModuleLock();
+	void ReleaseModuleLock();
+	void EnterModule();
+	bool TryEnterModule();
+	void LeaveModule();
+
+	void Reload();
+
+	static std::unordered_map<HMODULE, ModuleLock*> c_ModuleLocks;	// Main thread only
+
 	HMODULE m_Plugin;
+	ModuleLock* m_ModuleLock;
 
 	void* m_ReloadFunc;
 
@@ -78,6 +108,19 @@ private:
 	void* m_UpdateFunc;
 	void* m_GetStringFunc;
 	void* m_ExecuteBangFunc;
+
+	// With UpdateAsync=1, Update (and GetString) are called on the system thread pool. Only the
+	// thread pool touches m_AsyncValue and m_AsyncString while m_UpdateBusy is set, so the
+	// results are handed over to the UI thread without locking once it is cleared.
+	bool m_UpdateAsync;
+	volatile LONG m_UpdateBusy;
+	double m_AsyncValue;
+	std::wstring m_AsyncString;
+	bool m_AsyncHasString;
+	bool m_AsyncCallErrorLogged;	// Thread pool only
+	std::wstring m_StringValue;		// Last GetString result on the UI thread
+	bool m_HasStringValue;
+	bool m_ReloadPending;			// Reload was skipped while the plugin was busy
 };
 
 #endif
@@ -19,6 +19,7 @@
 #include "StdAfx.h"
 #include "MeasureVirtualMemory.h"
 #include "ConfigParser.h"
+#include "SystemMetrics.h"
 
 /*
 ** The constructor
@@ -27,9 +28,7 @@
 MeasureVirtualMemory::MeasureVirtualMemory(MeterWindow* meterWindow, const WCHAR* name) : Measure(meterWindow, name),
 	m_Total(false)
 {
-	MEMORYSTATUSEX stat;
-	stat.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&stat);
+	const MEMORYSTATUSEX& stat = SystemMetrics::GetMemoryStatus();
 	m_MaxValue = (double)(__int64)stat.ullTotalPageFile;
 }
 
@@ -47,9 +46,7 @@ MeasureVirtualMemory::~MeasureVirtualMemory()
 */
 void MeasureVirtualMemory::UpdateValue()
 {
-	MEMORYSTATUSEX stat;
-	stat.dwLength = sizeof(MEMORYSTATUSEX);
-	GlobalMemoryStatusEx(&stat);
+	const MEMORYSTATUSEX& stat = SystemMetrics::GetMemoryStatus();
 	m_MaxValue = (double)(__int64)stat.ullTotalPageFile;
 
 	if (m_Total)
@@ -0,0 +1,202 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+// Standalone benchmark comparing the AverageSize and LogMaxValue calculations of Measure::Update()
+// with the previous implementation (summing the whole window and sorting a copy of the median
+// values on every update). The functions below mirror the code in Measure.cpp. This file is not
+// part of any project and can be built on any platform, for example:
+//
+//   g++ -O2 -o Measure_Benchmark Measure_Benchmark.cpp
+//   cl /O2 /EHsc Measure_Benchmark.cpp
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const size_t MEDIAN_SIZE = 3;
+
+struct State
+{
+	std::vector<double> averageValues;
+	size_t averagePos;
+	double averageSum;
+	std::vector<double> medianValues;
+	size_t medianPos;
+	double minValue;
+	double maxValue;
+};
+
+void Reset(State& state)
+{
+	state.averageValues.clear();
+	state.averagePos = 0;
+	state.averageSum = 0.0;
+	state.medianValues.assign(MEDIAN_SIZE, 0.0);
+	state.medianPos = 0;
+	state.minValue = 0.0;
+	state.maxValue = 1.0;
+}
+
+// Same as Measure::Update() before the running sum.
+double UpdateOld(State& state, size_t averageSize, double value)
+{
+	if (averageSize != state.averageValues.size())
+	{
+		state.averageValues.resize(averageSize, value);
+		if (state.averagePos >= averageSize) state.averagePos = 0;
+	}
+	state.averageValues[state.averagePos] = value;
+
+	++state.averagePos;
+	state.averagePos %= averageSize;
+
+	double sum = 0;
+	for (size_t i = 0; i < averageSize; ++i)
+	{
+		sum += state.averageValues[i];
+	}
+	value = sum / (double)averageSize;
+
+	state.medianValues[state.medianPos] = value;
+	++state.medianPos;
+	state.medianPos %= MEDIAN_SIZE;
+
+	auto medianArray = state.medianValues;
+	std::sort(medianArray.begin(), medianArray.end());
+
+	const double medianValue = medianArray[MEDIAN_SIZE / 2];
+	state.maxValue = std::max(state.maxValue, medianValue);
+	state.minValue = std::min(state.minValue, medianValue);
+	return value;
+}
+
+// Same as the current Measure::Update().
+double UpdateNew(State& state, size_t averageSize, double value)
+{
+	bool resum = false;
+	if (averageSize != state.averageValues.size())
+	{
+		state.averageValues.resize(averageSize, value);
+		if (state.averagePos >= averageSize) state.averagePos = 0;
+		resum = true;
+	}
+
+	state.averageSum += value - state.averageValues[state.averagePos];
+	state.averageValues[state.averagePos] = value;
+
+	++state.averagePos;
+	state.averagePos %= averageSize;
+
+	if (resum || state.averagePos == 0)
+	{
+		state.averageSum = 0.0;
+		for (size_t i = 0; i < averageSize; ++i)
+		{
+			state.averageSum += state.averageValues[i];
+		}
+	}
+	value = state.averageSum / (double)averageSize;
+
+	state.medianValues[state.medianPos] = value;
+	++state.medianPos;
+	state.medianPos %= MEDIAN_SIZE;
+
+	const double a = state.medianValues[0];
+	const double b = state.medianValues[1];
+	const double c = state.medianValues[2];
+	const double medianValue = std::max(std::min(a, b), std::min(std::max(a, b), c));
+	state.maxValue = std::max(state.maxValue, medianValue);
+	state.minValue = std::min(state.minValue, medianValue);
+	return value;
+}
+
+template<typename Func>
+double Measure(Func func, int iterations)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		func(i);
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+}  // namespace
+
+int main()
+{
+	printf("%8s %14s %14s %8s\n", "average", "old (ns)", "new (ns)", "speedup");
+
+	// Synthetic network-like values: noise on top of a slow wave with occasional spikes.
+	const int valueCount = 1 << 16;
+	std::vector<double> values(valueCount);
+	unsigned int seed = 1;
+	for (int i = 0; i < valueCount; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		const double noise = (seed >> 16) % 1000;
+		values[i] = 50000.0 * (1.0 + std::sin(i * 0.05)) + noise * ((i % 97 == 0) ? 100.0 : 1.0);
+	}
+
+	const size_t averageSizes[] = { 5, 60, 600 };
+	const int iterations = 2000000;
+	bool identical = true;
+	volatile double sink = 0.0;
+
+	for (size_t averageSize : averageSizes)
+	{
+		State oldState;
+		Reset(oldState);
+		const double oldTime = Measure([&](int i)
+		{
+			sink = sink + UpdateOld(oldState, averageSize, values[i % valueCount]);
+		}, iterations);
+
+		State newState;
+		Reset(newState);
+		const double newTime = Measure([&](int i)
+		{
+			sink = sink + UpdateNew(newState, averageSize, values[i % valueCount]);
+		}, iterations);
+
+		// The running sum may differ from the full sum by rounding between the periodic re-sums.
+		Reset(oldState);
+		Reset(newState);
+		for (int i = 0; i < valueCount; ++i)
+		{
+			// Also change the window size now and then as a DynamicVariables reread would.
+			const size_t size = (i / 10000 % 2 == 0) ? averageSize : averageSize / 2 + 1;
+			const double oldValue = UpdateOld(oldState, size, values[i]);
+			const double newValue = UpdateNew(newState, size, values[i]);
+			identical = identical &&
+				std::fabs(oldValue - newValue) <= 1e-9 * std::fabs(oldValue) &&
+				std::fabs(oldState.maxValue - newState.maxValue) <= 1e-9 * std::fabs(oldState.maxValue) &&
+				std::fabs(oldState.minValue - newState.minValue) <= 1e-9 * std::fabs(oldState.minValue);
+		}
+
+		printf("%8zu %14.1f %14.1f %7.2fx\n", averageSize, oldTime, newTime, oldTime / newTime);
+	}
+
+	printf("Results %s\n", identical ? "match" : "DIFFER");
+	return identical ? 0 : 1;
+}
@@ -61,7 +61,9 @@ Meter::Meter(MeterWindow* meterWindow, const WCHAR* name) : Section(meterWindow,
 	m_SolidAngle(),
 	m_Padding(),
 	m_AntiAlias(false),
-	m_Initialized(false)
+	m_Initialized(false),
+	m_DrawCache(),
+	m_DrawCacheRect()
 {
 }
 
@@ -72,6 +74,7 @@ Meter::Meter(MeterWindow* meterWindow, const WCHAR* name) : Section(meterWindow,
 Meter::~Meter()
 {
 	delete m_Transformation;
+	delete m_DrawCache;
 
 	if (m_ToolTipHandle != nullptr)
 	{
@@ -183,6 +186,18 @@ Gdiplus::Rect Meter::GetMeterRectPadding()
 	return meterRect;
 }
 
+/*
+** Returns the area that Draw() paints to (before the transformation matrix is applied). Returns
+** false if the meter may paint outside of its bounds.
+**
+*/
+bool Meter::GetDrawRect(Gdiplus::Rect& rect)
+{
+	// Anti-aliased edges may extend a pixel past the bounds.
+	rect = Gdiplus::Rect(GetX() - 1, GetY() - 1, m_W + 2, m_H + 2);
+	return true;
+}
+
 /*
 ** Checks if the given point is inside the meter.
 ** This function doesn't check Hidden state, so check it before calling this function if needed.
@@ -247,6 +262,9 @@ void Meter::ReadOptions(ConfigParser& parser, const WCHAR* section)
 
 	Section::ReadOptions(parser, section);
 
+	// Any option may affect the output.
+	ResetDrawCache();
+
 	BindMeasures(parser, section);
 
 	int oldX = m_X;
@@ -739,6 +757,149 @@ bool Meter::Draw(Gfx::Canvas& canvas)
 	return true;
 }
 
+/*
+** Draws the meter with the output of an earlier Draw() if the options and the bounds have not
+** changed since the last frame and UpdateDrawCache() has not discarded it. The output is rendered
+** in |scratch| and cached once the meter has not changed for a frame.
+**
+*/
+bool Meter::DrawCached(Gfx::Canvas& canvas, Gfx::Canvas& scratch)
+{
+	if (IsHidden()) return false;
+
+	Rect rect;
+	if (!CanCacheDraw() || !GetDrawRect(rect))
+	{
+		ResetDrawCache();
+		return Draw(canvas);
+	}
+
+	const bool changed = !rect.Equals(m_DrawCacheRect);
+	m_DrawCacheRect = rect;
+
+	if (changed)
+	{
+		delete m_DrawCache;
+		m_DrawCache = nullptr;
+		return Draw(canvas);
+	}
+
+	if (!m_DrawCache)
+	{
+		if (scratch.GetW() < rect.Width || scratch.GetH() < rect.Height)
+		{
+			scratch.Resize(max(scratch.GetW(), rect.Width), max(scratch.GetH(), rect.Height));
+		}
+
+		if (!scratch.BeginDraw()) return Draw(canvas);
+
+		scratch.Clear();
+		scratch.SetTransform(Matrix(1.0f, 0.0f, 0.0f, 1.0f, (REAL)-rect.X, (REAL)-rect.Y));
+		Draw(scratch);
+		scratch.ResetTransform();
+
+		// Both canvas implementations use a top-down 32bpp premultiplied DIB.
+		DIBSECTION dib;
+		if (GetObject(scratch.GetBitmap(), sizeof(dib), &dib) == sizeof(dib) && dib.dsBm.bmBits)
+		{
+			m_DrawCache = new Bitmap(rect.Width, rect.Height, PixelFormat32bppPARGB);
+
+			BitmapData data;
+			const Rect lockRect(0, 0, rect.Width, rect.Height);
+			if (m_DrawCache->LockBits(&lockRect, ImageLockModeWrite, PixelFormat32bppPARGB, &data) == Ok)
+			{
+				const BYTE* src = (const BYTE*)dib.dsBm.bmBits;
+				for (int y = 0; y < rect.Height; ++y)
+				{
+					memcpy((BYTE*)data.Scan0 + y * data.Stride, src + y * dib.dsBm.bmWidthBytes, rect.Width * 4);
+				}
+				m_DrawCache->UnlockBits(&data);
+			}
+			else
+			{
+				delete m_DrawCache;
+				m_DrawCache = nullptr;
+			}
+		}
+
+		scratch.EndDraw();
+
+		if (!m_DrawCache) return Draw(canvas);
+	}
+
+	const Rect src(0, 0, rect.Width, rect.Height);
+	canvas.DrawBitmap(m_DrawCache, rect, src);
+	return true;
+}
+
+/*
+** Compares the state with the one in the previous call and stores it.
+**
+*/
+bool MeterDrawState::Update(const std::vector<Measure*>& measures, const WCHAR* text)
+{
+	bool changed = m_Values.size() != measures.size();
+	m_Values.resize(measures.size());
+	for (size_t i = 0, isize = measures.size(); i < isize; ++i)
+	{
+		Measure* measure = measures[i];
+		const double value = measure->GetValue();
+		const double minValue = measure->GetMinValue();
+		const double maxValue = measure->GetMaxValue();
+		const WCHAR* stringValue = measure->GetStringValue();
+		if (!stringValue) stringValue = L"";
+
+		Value& cached = m_Values[i];
+		if (cached.value != value || cached.minValue != minValue || cached.maxValue != maxValue ||
+			wcscmp(cached.string.c_str(), stringValue) != 0)
+		{
+			cached.value = value;
+			cached.minValue = minValue;
+			cached.maxValue = maxValue;
+			cached.string = stringValue;
+			changed = true;
+		}
+	}
+
+	if (wcscmp(m_Text.c_str(), text) != 0)
+	{
+		m_Text = text;
+		changed = true;
+	}
+
+	return changed;
+}
+
+/*
+** Must be called after Update() has updated the meter. The cached output of Draw() is discarded
+** if the MeterDrawState differs from the one in the previous Update(). It is compared here rather
+** than in DrawCached() as the meter may be drawn several times between updates (e.g. with
+** UpdateDivider).
+**
+*/
+void Meter::UpdateDrawCache()
+{
+	if (m_DrawState.Update(m_Measures, GetDrawText()))
+	{
+		// Drawn directly on the next frame and cached again after that.
+		delete m_DrawCache;
+		m_DrawCache = nullptr;
+		m_DrawCacheRect = Rect();
+	}
+}
+
+/*
+** Discards the cached output of Draw().
+**
+*/
+void Meter::ResetDrawCache()
+{
+	delete m_DrawCache;
+	m_DrawCache = nullptr;
+	m_DrawCacheRect = Rect();
+	m_DrawState.Clear();
+}
+
 /*
 ** Draws a bevel inside the given area
 */
@@ -32,6 +32,28 @@
 
 class Measure;
 
+// The inputs of Meter::Draw() that are not options or bounds: the values and ranges of the bound
+// measures (e.g. for GetRelativeValue()) and the text drawn by the meter. Update() returns true if
+// they have changed since the previous call.
+class MeterDrawState
+{
+public:
+	bool Update(const std::vector<Measure*>& measures, const WCHAR* text);
+	void Clear() { m_Values.clear(); m_Text.clear(); }
+
+private:
+	struct Value
+	{
+		double value;
+		double minValue;
+		double maxValue;
+		std::wstring string;
+	};
+
+	std::vector<Value> m_Values;
+	std::wstring m_Text;
+};
+
 class __declspec(novtable) Meter : public Section
 {
 public:
@@ -46,6 +68,9 @@ public:
 	virtual bool Draw(Gfx::Canvas& canvas);
 	virtual bool HasActiveTransition() { return false; }
 
+	bool DrawCached(Gfx::Canvas& canvas, Gfx::Canvas& scratch);
+	void UpdateDrawCache();
+
 	virtual int GetW() { return m_Hidden ? 0 : m_W; }
 	virtual int GetH() { return m_Hidden ? 0 : m_H; }
 	virtual int GetX(bool abs = false);
@@ -80,6 +105,8 @@ public:
 
 	virtual bool HitTest(int x, int y);
 
+	virtual bool GetDrawRect(Gdiplus::Rect& rect);
+
 	void SetMouseOver(bool over) { m_MouseOver = over; }
 	bool IsMouseOver() { return m_MouseOver; }
 
@@ -116,6 +143,14 @@ protected:
 
 	virtual bool IsFixedSize(bool overwrite = false) { return true; }
 
+	// Returns false if the output of Draw() may change while the options, the bounds, and the
+	// MeterDrawState in Update() stay the same.
+	virtual bool CanCacheDraw() { return true; }
+	void ResetDrawCache();
+
+	// Returns the text drawn by the meter for MeterDrawState.
+	virtual const WCHAR* GetDrawText() { return L""; }
+
 	bool BindPrimaryMeasure(ConfigParser& parser, const WCHAR* section, bool optional);
 	void BindSecondaryMeasures(ConfigParser& parser, const WCHAR* section);
 
@@ -156,6 +191,10 @@ protected:
 	Gdiplus::Rect m_Padding;
 	bool m_AntiAlias;
 	bool m_Initialized;
+
+	Gdiplus::Bitmap* m_DrawCache;				// Output of Draw() within m_DrawCacheRect
+	Gdiplus::Rect m_DrawCacheRect;
+	MeterDrawState m_DrawState;					// State in the last Update()
 };
 
 #endif
@@ -43,6 +43,8 @@ public:
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 
+	virtual bool CanCacheDraw() { return !HasActiveTransition(); }
+
 private:
 	TintedImage m_Image;
 	std::wstring m_ImageName;
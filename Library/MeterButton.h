@@ -52,6 +52,7 @@ protected:
 	virtual void BindMeasures(ConfigParser& parser, const WCHAR* section);
 	
 	virtual bool IsFixedSize(bool overwrite = false) { return overwrite; }
+	virtual bool CanCacheDraw() { return false; }  // Depends on the mouse state
 
 private:
 	TintedImage m_Image;
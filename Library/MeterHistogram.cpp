@@ -52,6 +52,8 @@ MeterHistogram::MeterHistogram(MeterWindow* meterWindow, const WCHAR* name) : Me
 	m_MinPrimaryValue(),
 	m_MaxSecondaryValue(1.0),
 	m_MinSecondaryValue(),
+	m_Surface(),
+	m_SurfaceNewValues(),
 	m_SizeChanged(true),
 	m_GraphStartLeft(false),
 	m_GraphHorizontalOrientation(false)
@@ -67,6 +69,17 @@ MeterHistogram::~MeterHistogram()
 	DisposeBuffer();
 }
 
+/*
+** Disposes the retained surface so that it is fully redrawn on the next Draw().
+**
+*/
+void MeterHistogram::DisposeSurface()
+{
+	delete m_Surface;
+	m_Surface = nullptr;
+	m_SurfaceNewValues = 0;
+}
+
 /*
 ** Disposes the buffers.
 **
@@ -82,6 +95,11 @@ void MeterHistogram::DisposeBuffer()
 
 	delete [] m_SecondaryValues;
 	m_SecondaryValues = nullptr;
+
+	m_PrimaryMax.Reset(0);
+	m_SecondaryMax.Reset(0);
+
+	DisposeSurface();
 }
 
 /*
@@ -97,9 +115,11 @@ void MeterHistogram::CreateBuffer()
 	if (maxSize > 0)
 	{
 		m_PrimaryValues = new double[maxSize]();
+		m_PrimaryMax.Reset(maxSize);
 		if (m_Measures.size() >= 2)
 		{
 			m_SecondaryValues = new double[maxSize]();
+			m_SecondaryMax.Reset(maxSize);
 		}
 	}
 }
@@ -206,6 +226,8 @@ void MeterHistogram::ReadOptions(ConfigParser& parser, const WCHAR* section)
 
 	Meter::ReadOptions(parser, section);
 
+	DisposeSurface();
+
 	m_PrimaryColor = parser.ReadColor(section, L"PrimaryColor", Color::Green);
 	m_SecondaryColor = parser.ReadColor(section, L"SecondaryColor", Color::Red);
 	m_OverlapColor = parser.ReadColor(section, L"BothColor", Color::Yellow);
@@ -331,14 +353,22 @@ bool MeterHistogram::Update()
 
 			// Gather values
 			m_PrimaryValues[m_MeterPos] = measure->GetValue();
+			m_PrimaryMax.Add(m_PrimaryValues[m_MeterPos]);
 
 			if (secondaryMeasure && m_SecondaryValues)
 			{
 				m_SecondaryValues[m_MeterPos] = secondaryMeasure->GetValue();
+				m_SecondaryMax.Add(m_SecondaryValues[m_MeterPos]);
 			}
 
 			++m_MeterPos;
 			m_MeterPos %= maxSize;
+			++m_SurfaceNewValues;
+
+			const double oldMaxPrimaryValue = m_MaxPrimaryValue;
+			const double oldMinPrimaryValue = m_MinPrimaryValue;
+			const double oldMaxSecondaryValue = m_MaxSecondaryValue;
+			const double oldMinSecondaryValue = m_MinSecondaryValue;
 
 			m_MaxPrimaryValue = measure->GetMaxValue();
 			m_MinPrimaryValue = measure->GetMinValue();
@@ -352,13 +382,7 @@ bool MeterHistogram::Update()
 
 			if (m_Autoscale)
 			{
-				// Go through all values and find the max
-
-				double newValue = 0.0;
-				for (int i = 0; i < maxSize; ++i)
-				{
-					newValue = max(newValue, m_PrimaryValues[i]);
-				}
+				double newValue = m_PrimaryMax.Get();
 
 				// Scale the value up to nearest power of 2
 				if (newValue > DBL_MAX / 2.0)
@@ -376,10 +400,7 @@ bool MeterHistogram::Update()
 
 				if (secondaryMeasure && m_SecondaryValues)
 				{
-					for (int i = 0; i < maxSize; ++i)
-					{
-						newValue = max(newValue, m_SecondaryValues[i]);
-					}
+					newValue = m_SecondaryMax.Get(newValue);
 
 					// Scale the value up to nearest power of 2
 					if (newValue > DBL_MAX / 2.0)
@@ -396,6 +417,15 @@ bool MeterHistogram::Update()
 					}
 				}
 			}
+
+			if (m_MaxPrimaryValue != oldMaxPrimaryValue ||
+				m_MinPrimaryValue != oldMinPrimaryValue ||
+				m_MaxSecondaryValue != oldMaxSecondaryValue ||
+				m_MinSecondaryValue != oldMinSecondaryValue)
+			{
+				// All of the bars need to be rescaled.
+				DisposeSurface();
+			}
 		}
 		return true;
 	}
@@ -414,6 +444,14 @@ bool MeterHistogram::Draw(Gfx::Canvas& canvas)
 
 	Gdiplus::Graphics& graphics = canvas.BeginGdiplusContext();
 
+	Gdiplus::Rect meterRect = GetMeterRectPadding();
+
+	if (DrawSurface(graphics, meterRect))
+	{
+		canvas.EndGdiplusContext();
+		return true;
+	}
+
 	Measure* secondaryMeasure = (m_Measures.size() >= 2) ? m_Measures[1] : nullptr;
 
 	GraphicsPath primaryPath;
@@ -424,8 +462,6 @@ bool MeterHistogram::Draw(Gfx::Canvas& canvas)
 	Bitmap* secondaryBitmap = m_SecondaryImage.GetImage();
 	Bitmap* bothBitmap = m_OverlapImage.GetImage();
 
-	Gdiplus::Rect meterRect = GetMeterRectPadding();
-
 	// Default values (GraphStart=Right, GraphOrientation=Vertical)
 	int i;
 	int startValue = 0;
@@ -591,9 +627,10 @@ bool MeterHistogram::Draw(Gfx::Canvas& canvas)
 	{
 		Rect r(meterRect.X, meterRect.Y, primaryBitmap->GetWidth(), primaryBitmap->GetHeight());
 
-		graphics.SetClip(&primaryPath);
+		const GraphicsState state = graphics.Save();
+		graphics.SetClip(&primaryPath, CombineModeIntersect);  // Keep the canvas clip
 		graphics.DrawImage(primaryBitmap, r, 0, 0, r.Width, r.Height, UnitPixel);
-		graphics.ResetClip();
+		graphics.Restore(state);
 	}
 	else
 	{
@@ -606,9 +643,10 @@ bool MeterHistogram::Draw(Gfx::Canvas& canvas)
 		{
 			Rect r(meterRect.X, meterRect.Y, secondaryBitmap->GetWidth(), secondaryBitmap->GetHeight());
 
-			graphics.SetClip(&secondaryPath);
+			const GraphicsState state = graphics.Save();
+			graphics.SetClip(&secondaryPath, CombineModeIntersect);
 			graphics.DrawImage(secondaryBitmap, r, 0, 0, r.Width, r.Height, UnitPixel);
-			graphics.ResetClip();
+			graphics.Restore(state);
 		}
 		else
 		{
@@ -619,9 +657,10 @@ bool MeterHistogram::Draw(Gfx::Canvas& canvas)
 		{
 			Rect r(meterRect.X, meterRect.Y, bothBitmap->GetWidth(), bothBitmap->GetHeight());
 
-			graphics.SetClip(&bothPath);
+			const GraphicsState state = graphics.Save();
+			graphics.SetClip(&bothPath, CombineModeIntersect);
 			graphics.DrawImage(bothBitmap, r, 0, 0, r.Width, r.Height, UnitPixel);
-			graphics.ResetClip();
+			graphics.Restore(state);
 		}
 		else
 		{
@@ -635,6 +674,198 @@ bool MeterHistogram::Draw(Gfx::Canvas& canvas)
 	return true;
 }
 
+/*
+** Calculates the bar lengths of the values at |index| in the buffers. |secondary| is set to -1
+** if there is no secondary measure.
+**
+*/
+void MeterHistogram::GetBarLengths(int index, int maxLength, int& primary, int& secondary)
+{
+	double value = (m_MaxPrimaryValue == 0.0) ?
+		  0.0
+		: m_PrimaryValues[index] / m_MaxPrimaryValue;
+	value -= m_MinPrimaryValue;
+	primary = (int)(maxLength * value);
+	primary = min(maxLength, primary);
+	primary = max(0, primary);
+
+	secondary = -1;
+	if (m_Measures.size() >= 2)
+	{
+		value = (m_MaxSecondaryValue == 0.0) ?
+			  0.0
+			: m_SecondaryValues[index] / m_MaxSecondaryValue;
+		value -= m_MinSecondaryValue;
+		secondary = (int)(maxLength * value);
+		secondary = min(maxLength, secondary);
+		secondary = max(0, secondary);
+	}
+}
+
+/*
+** Draws solid color histograms from a retained surface that holds the bar of each value in the
+** buffers at the position of the value (or mirrored when the graph runs backwards). Only the
+** values added since the last call are drawn into the surface, and the surface is then drawn
+** onto the canvas in two parts so that the oldest value is at the start of the graph. Returns
+** false if the histogram must be drawn normally.
+**
+*/
+bool MeterHistogram::DrawSurface(Gdiplus::Graphics& graphics, const Gdiplus::Rect& meterRect)
+{
+	// The images are positioned relative to the meter rather than to the values and the surface
+	// cannot be split without seams when transformed.
+	Matrix matrix;
+	graphics.GetTransform(&matrix);
+	if (m_PrimaryImage.GetImage() || m_SecondaryImage.GetImage() || m_OverlapImage.GetImage() ||
+		!matrix.IsIdentity() || meterRect.Width <= 0 || meterRect.Height <= 0)
+	{
+		DisposeSurface();
+		return false;
+	}
+
+	const int size = m_GraphHorizontalOrientation ? meterRect.Height : meterRect.Width;
+	const int maxLength = m_GraphHorizontalOrientation ? meterRect.Width : meterRect.Height;
+	const int maxSize = m_GraphHorizontalOrientation ? m_H : m_W;
+	if (size != maxSize)
+	{
+		// The buffers are larger than the graph with Padding.
+		DisposeSurface();
+		return false;
+	}
+
+	if (m_Surface &&
+		((int)m_Surface->GetWidth() != meterRect.Width || (int)m_Surface->GetHeight() != meterRect.Height))
+	{
+		DisposeSurface();
+	}
+
+	bool redraw = false;
+	if (!m_Surface)
+	{
+		m_Surface = new Bitmap(meterRect.Width, meterRect.Height, PixelFormat32bppPARGB);
+		if (m_Surface->GetLastStatus() != Ok)
+		{
+			DisposeSurface();
+			return false;
+		}
+
+		redraw = true;
+	}
+
+	if (redraw || m_SurfaceNewValues > 0)
+	{
+		Graphics surfaceGraphics(m_Surface);
+		surfaceGraphics.SetCompositingMode(CompositingModeSourceCopy);
+
+		if (redraw || m_SurfaceNewValues >= size)
+		{
+			surfaceGraphics.Clear(Color(0, 0, 0, 0));
+			for (int i = 0; i < size; ++i)
+			{
+				DrawSurfaceValue(surfaceGraphics, i, size, maxLength);
+			}
+		}
+		else
+		{
+			// The newest values are just before |m_MeterPos|.
+			for (int i = size - m_SurfaceNewValues; i < size; ++i)
+			{
+				DrawSurfaceValue(surfaceGraphics, (m_MeterPos + i) % size, size, maxLength);
+			}
+		}
+
+		m_SurfaceNewValues = 0;
+	}
+
+	const bool reverse = m_GraphHorizontalOrientation ? m_Flip : m_GraphStartLeft;
+	const int shift = reverse ? (size - m_MeterPos) % size : m_MeterPos;
+
+	// Pixel |i| along the graph shows pixel |(i + shift) % size| of the surface.
+	const int parts[2][3] =
+	{
+		{ 0, shift, size - shift },
+		{ size - shift, 0, shift }
+	};
+
+	// Copy the pixels exactly so that the parts are seamless.
+	const GraphicsState state = graphics.Save();
+	graphics.SetInterpolationMode(InterpolationModeNearestNeighbor);
+	graphics.SetPixelOffsetMode(PixelOffsetModeHalf);
+
+	for (int i = 0; i < 2; ++i)
+	{
+		const int length = parts[i][2];
+		if (length <= 0) continue;
+
+		if (m_GraphHorizontalOrientation)
+		{
+			Rect r(meterRect.X, meterRect.Y + parts[i][0], meterRect.Width, length);
+			graphics.DrawImage(m_Surface, r, 0, parts[i][1], r.Width, r.Height, UnitPixel);
+		}
+		else
+		{
+			Rect r(meterRect.X + parts[i][0], meterRect.Y, length, meterRect.Height);
+			graphics.DrawImage(m_Surface, r, parts[i][1], 0, r.Width, r.Height, UnitPixel);
+		}
+	}
+
+	graphics.Restore(state);
+	return true;
+}
+
+/*
+** Draws the bars of the value at |index| in the buffers into the retained surface.
+**
+*/
+void MeterHistogram::DrawSurfaceValue(Gdiplus::Graphics& graphics, int index, int size, int maxLength)
+{
+	int primary, secondary;
+	GetBarLengths(index, maxLength, primary, secondary);
+
+	const bool reverse = m_GraphHorizontalOrientation ? m_Flip : m_GraphStartLeft;
+	const int pos = reverse ? size - 1 - index : index;
+
+	// Returns the rectangle between |start| and |end| from the base of the bar.
+	auto getRect = [&](int start, int end)
+	{
+		return m_GraphHorizontalOrientation ?
+			  Rect(m_GraphStartLeft ? start : maxLength - end, pos, end - start, 1)
+			: Rect(pos, m_Flip ? start : maxLength - end, 1, end - start);
+	};
+
+	SolidBrush clearBrush(Color(0, 0, 0, 0));
+	graphics.FillRectangle(&clearBrush, getRect(0, maxLength));
+
+	if (secondary == -1)
+	{
+		if (primary > 0)
+		{
+			SolidBrush brush(m_PrimaryColor);
+			graphics.FillRectangle(&brush, getRect(0, primary));
+		}
+	}
+	else
+	{
+		const int both = min(primary, secondary);
+		if (both > 0)
+		{
+			SolidBrush brush(m_OverlapColor);
+			graphics.FillRectangle(&brush, getRect(0, both));
+		}
+
+		if (secondary > primary)
+		{
+			SolidBrush brush(m_SecondaryColor);
+			graphics.FillRectangle(&brush, getRect(both, secondary));
+		}
+		else if (primary > both)
+		{
+			SolidBrush brush(m_PrimaryColor);
+			graphics.FillRectangle(&brush, getRect(both, primary));
+		}
+	}
+}
+
 /*
 ** Overwritten method to handle the secondary measure binding.
 **
@@ -21,6 +21,7 @@
 
 #include "Meter.h"
 #include "TintedImage.h"
+#include "../Common/SlidingMaximum.h"
 
 class MeterHistogram : public Meter
 {
@@ -42,11 +43,18 @@ protected:
 	virtual void BindMeasures(ConfigParser& parser, const WCHAR* section);
 
 	virtual bool IsFixedSize(bool overwrite = false) { return m_PrimaryImageName.empty(); }
+	virtual bool CanCacheDraw() { return false; }  // Draws the value history
 
 private:
 	void DisposeBuffer();
 	void CreateBuffer();
 
+	void GetBarLengths(int index, int maxLength, int& primary, int& secondary);
+
+	bool DrawSurface(Gdiplus::Graphics& graphics, const Gdiplus::Rect& meterRect);
+	void DrawSurfaceValue(Gdiplus::Graphics& graphics, int index, int size, int maxLength);
+	void DisposeSurface();
+
 	Gdiplus::Color m_PrimaryColor;
 	Gdiplus::Color m_SecondaryColor;
 	Gdiplus::Color m_OverlapColor;
@@ -70,6 +78,12 @@ private:
 	double* m_PrimaryValues;
 	double* m_SecondaryValues;
 
+	SlidingMaximum m_PrimaryMax;			// Maximums of the values in the buffers for AutoScale
+	SlidingMaximum m_SecondaryMax;
+
+	Gdiplus::Bitmap* m_Surface;				// Retained bars of solid color histograms
+	int m_SurfaceNewValues;					// Values added since the surface was last drawn
+
 	double m_MaxPrimaryValue;
 	double m_MinPrimaryValue;
 	double m_MaxSecondaryValue;
@@ -66,9 +66,9 @@ void MeterImage::Initialize()
 ** Loads the image from disk
 **
 */
-void MeterImage::LoadImage(const std::wstring& imageName, bool bLoadAlways)
+void MeterImage::LoadImage(const std::wstring& imageName, bool bLoadAlways, bool async)
 {
-	m_Image.LoadImage(imageName, bLoadAlways);
+	m_Image.LoadImage(imageName, bLoadAlways, async);
 
 	if (m_Image.IsLoaded())
 	{
@@ -186,7 +186,8 @@ bool MeterImage::Update()
 				m_ImageNameResult = m_ImageName;
 			}
 			
-			LoadImage(m_ImageNameResult, (wcscmp(oldResult.c_str(), m_ImageNameResult.c_str()) != 0));
+			// Decode new images in the background and keep drawing the current one meanwhile.
+			LoadImage(m_ImageNameResult, (wcscmp(oldResult.c_str(), m_ImageNameResult.c_str()) != 0), true);
 			return true;
 		}
 		else if (m_NeedsRedraw)
@@ -43,6 +43,9 @@ protected:
 	
 	virtual bool IsFixedSize(bool overwrite = false) { return overwrite ? true : m_ImageName.empty(); }
 
+	// The image is reloaded on updates in these cases and the file may have changed.
+	virtual bool CanCacheDraw() { return m_Measures.empty() && !m_DynamicVariables; }
+
 private:
 	enum DRAWMODE
 	{
@@ -52,7 +55,7 @@ private:
 		DRAWMODE_KEEPRATIOANDCROP
 	};
 
-	void LoadImage(const std::wstring& imageName, bool bLoadAlways);
+	void LoadImage(const std::wstring& imageName, bool bLoadAlways, bool async = false);
 
 	TintedImage m_Image;
 	std::wstring m_ImageName;
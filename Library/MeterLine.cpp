@@ -20,6 +20,7 @@
 #include "MeterLine.h"
 #include "Measure.h"
 #include "Logger.h"
+#include "../Common/GraphUtil.h"
 #include "../Common/Gfx/Canvas.h"
 
 using namespace Gdiplus;
@@ -94,6 +95,32 @@ void MeterLine::Initialize()
 			}
 		}
 	}
+
+	ResetMaxValues();
+}
+
+/*
+** Recalculates the maximums used for AutoScale from the values of the lines.
+**
+*/
+void MeterLine::ResetMaxValues()
+{
+	const size_t allValuesSize = m_AllValues.size();
+	m_MaxValues.resize(allValuesSize);
+
+	for (size_t i = 0; i < allValuesSize; ++i)
+	{
+		const std::vector<double>& values = m_AllValues[i];
+		const double scale = m_ScaleValues[i];
+		const size_t num = values.size();
+
+		m_MaxValues[i].Reset(num);
+		for (size_t j = 0; j < num; ++j)
+		{
+			// Add the values from the oldest to the newest
+			m_MaxValues[i].Add(values[(m_CurrentPos + j) % num] * scale);
+		}
+	}
 }
 
 /*
@@ -185,6 +212,10 @@ void MeterLine::ReadOptions(ConfigParser& parser, const WCHAR* section)
 			m_CurrentPos = 0;
 			Initialize();
 		}
+		else
+		{
+			ResetMaxValues();  // The scales may have changed
+		}
 	}
 }
 
@@ -207,6 +238,13 @@ bool MeterLine::Update()
 				m_AllValues[counter][m_CurrentPos] = (*i)->GetValue();
 			}
 
+			// Lines without a measure keep their old value, which is added again to keep all of
+			// the maximums in step with |m_CurrentPos|.
+			for (int i = 0; i < allValuesSize; ++i)
+			{
+				m_MaxValues[i].Add(m_AllValues[i][m_CurrentPos] * m_ScaleValues[i]);
+			}
+
 			++m_CurrentPos;
 			m_CurrentPos %= maxSize;
 		}
@@ -233,16 +271,9 @@ bool MeterLine::Draw(Gfx::Canvas& canvas)
 	if (m_Autoscale)
 	{
 		double newValue = 0;
-		counter = 0;
-		for (auto i = m_AllValues.cbegin(); i != m_AllValues.cend(); ++i)
+		for (auto i = m_MaxValues.cbegin(); i != m_MaxValues.cend(); ++i)
 		{
-			double scale = m_ScaleValues[counter];
-			for (auto j = (*i).cbegin(); j != (*i).cend(); ++j)
-			{
-				double val = (*j) * scale;
-				newValue = max(newValue, val);
-			}
-			++counter;
+			newValue = (*i).Get(newValue);
 		}
 
 		// Scale the value up to nearest power of 2
@@ -303,129 +334,57 @@ bool MeterLine::Draw(Gfx::Canvas& canvas)
 	}
 
 	// Draw all the lines
-
-	if (m_GraphHorizontalOrientation)
+	const int num = min(
+		m_GraphHorizontalOrientation ? meterRect.Height : meterRect.Width,
+		m_AllValues.empty() ? 0 : (int)m_AllValues[0].size());
+	if (num > 1)
 	{
-		const REAL W = meterRect.Width - 1.0f;
-		counter = 0;
-		for (auto i = m_AllValues.cbegin(); i != m_AllValues.cend(); ++i)
-		{
-			// Draw a line
-			REAL X, oldX;
-
-			const double scale = m_ScaleValues[counter] * W / maxValue;
-
-			int pos = m_CurrentPos;
+		m_Coords.resize(num);
+		m_Points.resize(num);
 
-			auto calcX = [&](REAL& _x)
-			{
-				_x = (REAL)((*i)[pos] * scale);
-				_x = min(_x, W);
-				_x = max(_x, 0.0f);
-				_x = meterRect.X + (m_GraphStartLeft ? _x : W - _x);
-			};
-
-			calcX(oldX);
-
-			// Cache all lines
-			GraphicsPath path;
-		
-			if (!m_Flip)
+		// The points are spaced one pixel apart along the time axis and the values of each line
+		// are converted into the other coordinate at once.
+		for (int j = 0; j < num; ++j)
+		{
+			if (m_GraphHorizontalOrientation)
 			{
-				for (int j = meterRect.Y + 1, R = meterRect.Y + meterRect.Height; j < R; ++j)
-				{
-					++pos;
-					pos %= meterRect.Height;
-
-					calcX(X);
-
-					path.AddLine(oldX, (REAL)(j - 1), X, (REAL)j);
-
-					oldX = X;
-				}
+				m_Points[j].Y = (REAL)(m_Flip ? meterRect.Y + num - 1 - j : meterRect.Y + j);
 			}
 			else
 			{
-				for (int j = meterRect.Y + meterRect.Height, R = meterRect.Y + 1; j > R; --j)
-				{
-					++pos;
-					pos %= meterRect.Height;
-
-					calcX(X);
-
-					path.AddLine(oldX, (REAL)(j - 1), X, (REAL)(j - 2));
-
-					oldX = X;
-				}
+				m_Points[j].X = (REAL)(m_GraphStartLeft ? meterRect.X + num - 1 - j : meterRect.X + j);
 			}
+		}
 
-			// Draw cached lines
-			Pen pen(m_Colors[counter], (REAL)m_LineWidth);
-			pen.SetLineJoin(LineJoinBevel);
-			graphics.DrawPath(&pen, &path);
+		const REAL range = (m_GraphHorizontalOrientation ? meterRect.Width : meterRect.Height) - 1.0f;
+		const REAL origin = (REAL)(m_GraphHorizontalOrientation ? meterRect.X : meterRect.Y);
+		const bool invert = m_GraphHorizontalOrientation ? !m_GraphStartLeft : !m_Flip;
 
-			++counter;
-		}
-	}
-	else
-	{
-		const REAL H = meterRect.Height - 1.0f;
 		counter = 0;
 		for (auto i = m_AllValues.cbegin(); i != m_AllValues.cend(); ++i)
 		{
-			// Draw a line
-			REAL Y, oldY;
-
-			const double scale = m_ScaleValues[counter] * H / maxValue;
-
-			int pos = m_CurrentPos;
+			const double scale = m_ScaleValues[counter] * range / maxValue;
+			GraphUtil::ScaleRingBuffer(
+				&(*i)[0], num, m_CurrentPos % num, scale, range, origin, invert, &m_Coords[0]);
 
-			auto calcY = [&](REAL& _y)
+			if (m_GraphHorizontalOrientation)
 			{
-				_y = (REAL)((*i)[pos] * scale);
-				_y = min(_y, H);
-				_y = max(_y, 0.0f);
-				_y = meterRect.Y + (m_Flip ? _y : H - _y);
-			};
-
-			calcY(oldY);
-
-			// Cache all lines
-			GraphicsPath path;
-		
-			if (!m_GraphStartLeft)
-			{
-				for (int j = meterRect.X + 1, R = meterRect.X + meterRect.Width; j < R; ++j)
+				for (int j = 0; j < num; ++j)
 				{
-					++pos;
-					pos %= meterRect.Width;
-
-					calcY(Y);
-
-					path.AddLine((REAL)(j - 1), oldY, (REAL)j, Y);
-
-					oldY = Y;
+					m_Points[j].X = m_Coords[j];
 				}
 			}
 			else
 			{
-				for (int j = meterRect.X + meterRect.Width, R = meterRect.X + 1; j > R; --j)
+				for (int j = 0; j < num; ++j)
 				{
-					++pos;
-					pos %= meterRect.Width;
-
-					calcY(Y);
-
-					path.AddLine((REAL)(j - 1), oldY, (REAL)(j - 2), Y);
-
-					oldY = Y;
+					m_Points[j].Y = m_Coords[j];
 				}
 			}
 
-			// Draw cached lines
 			Pen pen(m_Colors[counter], (REAL)m_LineWidth);
 			pen.SetLineJoin(LineJoinBevel);
-			graphics.DrawPath(&pen, &path);
+			graphics.DrawLines(&pen, &m_Points[0], num);
 
 			++counter;
 		}
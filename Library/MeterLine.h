@@ -20,6 +20,7 @@
 #define __METERLINE_H__
 
 #include "Meter.h"
+#include "../Common/SlidingMaximum.h"
 
 class MeterLine : public Meter
 {
@@ -40,7 +41,11 @@ protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
 	virtual void BindMeasures(ConfigParser& parser, const WCHAR* section);
 
+	virtual bool CanCacheDraw() { return false; }  // Draws the value history
+
 private:
+	void ResetMaxValues();
+
 	std::vector<Gdiplus::Color> m_Colors;
 	std::vector<double> m_ScaleValues;
 
@@ -51,6 +56,9 @@ private:
 	Gdiplus::Color m_HorizontalColor;
 
 	std::vector< std::vector<double> > m_AllValues;
+	std::vector<SlidingMaximum> m_MaxValues;	// Maximum of the scaled values of each line
+	std::vector<float> m_Coords;				// Reused by Draw() to avoid allocating each frame
+	std::vector<Gdiplus::PointF> m_Points;
 	int m_CurrentPos;
 
 	bool m_GraphStartLeft;
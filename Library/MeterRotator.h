@@ -36,6 +36,7 @@ public:
 	virtual void Initialize();
 	virtual bool Update();
 	virtual bool Draw(Gfx::Canvas& canvas);
+	virtual bool GetDrawRect(Gdiplus::Rect& rect) { return false; }  // Not limited to W/H
 
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
@@ -34,6 +34,7 @@ public:
 
 	virtual bool Update();
 	virtual bool Draw(Gfx::Canvas& canvas);
+	virtual bool GetDrawRect(Gdiplus::Rect& rect) { return false; }  // Not limited to W/H
 
 protected:
 	virtual void ReadOptions(ConfigParser& parser, const WCHAR* section);
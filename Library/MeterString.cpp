@@ -78,7 +78,10 @@ MeterString::MeterString(MeterWindow* meterWindow, const WCHAR* name) : Meter(me
 	m_ClipStringH(-1),
 	m_TextFormat(meterWindow->GetCanvas().CreateTextFormat()),
 	m_NumOfDecimals(-1),
-	m_Angle()
+	m_Angle(),
+	m_MeasuredW(1),
+	m_MeasuredH(1),
+	m_NeedsMeasure(true)
 {
 }
 
@@ -156,6 +159,8 @@ void MeterString::Initialize()
 		(m_Style & BOLD) != 0,
 		(m_Style & ITALIC) != 0,
 		m_MeterWindow->GetFontCollection());
+
+	m_NeedsMeasure = true;
 }
 
 /*
@@ -340,6 +345,8 @@ void MeterString::ReadOptions(ConfigParser& parser, const WCHAR* section)
 	{
 		Initialize();	// Recreate the font
 	}
+
+	m_NeedsMeasure = true;
 }
 
 /*
@@ -353,26 +360,43 @@ bool MeterString::Update()
 		int decimals = (m_NumOfDecimals != -1) ? m_NumOfDecimals : (m_NoDecimals && (m_Percentual || m_AutoScale == AUTOSCALE_OFF)) ? 0 : 1;
 
 		// Create the text
-		m_String = m_Prefix;
+		std::wstring text = m_Prefix;
 		if (!m_Measures.empty())
 		{
 			if (m_Text.empty())
 			{
-				m_String += m_Measures[0]->GetStringOrFormattedValue(
+				text += m_Measures[0]->GetStringOrFormattedValue(
 					m_AutoScale, m_Scale, decimals, m_Percentual);
 			}
 			else
 			{
 				std::wstring tmpText = m_Text;
 				ReplaceMeasures(tmpText, m_AutoScale, m_Scale, decimals, m_Percentual);
-				m_String += tmpText;
+				text += tmpText;
 			}
 		}
 		else
 		{
-			m_String += m_Text;
+			text += m_Text;
+		}
+		if (!m_Postfix.empty()) text += m_Postfix;
+
+		// The measured size depends on the text, the options (see m_NeedsMeasure) and the defined
+		// W or H, which may have been changed with SetW/SetH since the text was measured.
+		const bool measureSize = !m_WDefined || !m_HDefined;
+		if (!m_NeedsMeasure && text == m_RawString &&
+			(!measureSize ||
+			((!m_WDefined || m_W == m_MeasuredW) && (!m_HDefined || m_H == m_MeasuredH))))
+		{
+			// The string and its size (as well as the text layout kept by the text format) are
+			// still valid. Only the measured dimensions are restored.
+			if (!m_WDefined) m_W = m_MeasuredW;
+			if (!m_HDefined) m_H = m_MeasuredH;
+			return true;
 		}
-		if (!m_Postfix.empty()) m_String += m_Postfix;
+
+		m_RawString = text;
+		m_String.swap(text);
 
 		switch (m_Case)
 		{
@@ -408,7 +432,7 @@ bool MeterString::Update()
 			}
 		}
 
-		if (!m_WDefined || !m_HDefined)
+		if (measureSize)
 		{
 			// Calculate the text size
 			RectF rect;
@@ -422,8 +446,12 @@ bool MeterString::Update()
 				m_W = 1;
 				m_H = 1;
 			}
+
+			m_MeasuredW = m_W;
+			m_MeasuredH = m_H;
 		}
 
+		m_NeedsMeasure = false;
 		return true;
 	}
 	return false;
@@ -440,6 +468,23 @@ bool MeterString::Draw(Gfx::Canvas& canvas)
 	return DrawString(canvas, nullptr);
 }
 
+/*
+** Overridden method. Rotated and unclipped text may be drawn outside of the meter.
+**
+*/
+bool MeterString::GetDrawRect(Gdiplus::Rect& rect)
+{
+	const bool clipped =
+		m_ClipType == CLIP_ON ||
+		(m_ClipType == CLIP_AUTO && (m_NeedsClipping || (m_WDefined && m_HDefined)));
+	if (m_Angle != 0.0f || (!clipped && (m_WDefined || m_HDefined)))
+	{
+		return false;
+	}
+
+	return Meter::GetDrawRect(rect);
+}
+
 /*
 ** Draws the string or calculates it's size
 **
@@ -39,8 +39,9 @@ public:
 
 	virtual void Initialize();
 	virtual bool Update();
-	void SetText(const WCHAR* text) { m_Text = text; }
+	void SetText(const WCHAR* text) { m_Text = text; ResetDrawCache(); }
 	virtual bool Draw(Gfx::Canvas& canvas);
+	virtual bool GetDrawRect(Gdiplus::Rect& rect);
 	Gdiplus::RectF GetRect() { return m_Rect; }
 
 	static void EnumerateInstalledFontFamilies();
@@ -53,6 +54,7 @@ protected:
 	virtual void BindMeasures(ConfigParser& parser, const WCHAR* section);
 
 	virtual bool IsFixedSize(bool overwrite = false) { return overwrite; }
+	virtual const WCHAR* GetDrawText() { return m_String.c_str(); }
 
 private:
 	enum TEXTSTYLE
@@ -111,6 +113,10 @@ private:
 	Gdiplus::RectF m_Rect;
 
 	std::wstring m_String;
+	std::wstring m_RawString;		// m_String before the case conversion and fixups
+	int m_MeasuredW;
+	int m_MeasuredH;
+	bool m_NeedsMeasure;
 };
 
 #endif
@@ -32,8 +32,10 @@
 #include "MeterString.h"
 #include "TintedImage.h"
 #include "MeasureScript.h"
+#include "SystemMetrics.h"
 #include "../Version.h"
 #include "../Common/PathUtil.h"
+#include "../Common/Timer.h"
 #include "../Common/Gfx/Canvas.h"
 
 using namespace Gdiplus;
@@ -44,7 +46,6 @@ using namespace Gdiplus;
 
 enum TIMER
 {
-	TIMER_METER      = 1,
 	TIMER_MOUSE      = 2,
 	TIMER_FADE       = 3,
 	TIMER_TRANSITION = 4,
@@ -58,6 +59,25 @@ enum INTERVAL
 	INTERVAL_TRANSITION = 100
 };
 
+namespace {
+
+// Extends |rect| to contain |other|. Empty rects are ignored.
+void UnionRect(Rect& rect, const Rect& other)
+{
+	if (other.IsEmptyArea()) return;
+
+	if (rect.IsEmptyArea())
+	{
+		rect = other;
+	}
+	else
+	{
+		Rect::Union(rect, rect, other);
+	}
+}
+
+}  // namespace
+
 int MeterWindow::c_InstanceCount = 0;
 
 HINSTANCE MeterWindow::c_DwmInstance = nullptr;
@@ -72,6 +92,7 @@ decltype(DwmIsCompositionEnabled)* MeterWindow::c_DwmIsCompositionEnabled = null
 */
 MeterWindow::MeterWindow(const std::wstring& folderPath, const std::wstring& file) : m_FolderPath(folderPath), m_FileName(file),
 	m_Canvas(),
+	m_CacheCanvas(),
 	m_Background(),
 	m_BackgroundSize(),
 	m_Window(),
@@ -134,6 +155,13 @@ MeterWindow::MeterWindow(const std::wstring& folderPath, const std::wstring& fil
 	m_State(STATE_INITIALIZING),
 	m_Hidden(false),
 	m_ResizeWindow(RESIZEMODE_NONE),
+	m_DirtyRect(),
+	m_RepaintedPixels(),
+	m_RepaintedPixelsStartTime(),
+	m_RepaintedPixelsPerSecond(),
+	m_PresentedBytes(),
+	m_PresentTime(),
+	m_PresentCount(),
 	m_UpdateCounter(),
 	m_MouseMoveCounter(),
 	m_FontCollection(),
@@ -207,7 +235,7 @@ MeterWindow::~MeterWindow()
 void MeterWindow::Dispose(bool refresh)
 {
 	// Kill the timer/hook
-	KillTimer(m_Window, TIMER_METER);
+	GetRainmeter().UnscheduleUpdate(this);
 	KillTimer(m_Window, TIMER_MOUSE);
 	KillTimer(m_Window, TIMER_FADE);
 	KillTimer(m_Window, TIMER_TRANSITION);
@@ -228,6 +256,8 @@ void MeterWindow::Dispose(bool refresh)
 		delete (*j);
 	}
 	m_Meters.clear();
+	m_MeterDrawRects.clear();
+	m_DirtyRect = Rect();
 
 	// Destroy the measures
 	for (auto i = m_Measures.begin(); i != m_Measures.end(); ++i)
@@ -265,6 +295,9 @@ void MeterWindow::Dispose(bool refresh)
 
 	delete m_Canvas;
 	m_Canvas = nullptr;
+
+	delete m_CacheCanvas;
+	m_CacheCanvas = nullptr;
 }
 
 /*
@@ -453,7 +486,7 @@ void MeterWindow::Refresh(bool init, bool all)
 	// Start the timers
 	if (m_WindowUpdate >= 0)
 	{
-		SetTimer(m_Window, TIMER_METER, m_WindowUpdate, nullptr);
+		GetRainmeter().ScheduleUpdate(this, m_WindowUpdate);
 	}
 
 	SetTimer(m_Window, TIMER_MOUSE, INTERVAL_MOUSE, nullptr);
@@ -462,6 +495,11 @@ void MeterWindow::Refresh(bool init, bool all)
 
 	m_State = STATE_RUNNING;
 
+	if (!init && GetRainmeter().GetDebug())
+	{
+		TintedImage::LogCacheStats();
+	}
+
 	if (!m_OnRefreshAction.empty())
 	{
 		GetRainmeter().ExecuteCommand(m_OnRefreshAction.c_str(), this);
@@ -707,12 +745,7 @@ void MeterWindow::DoBang(Bang bang, const std::vector<std::wstring>& args)
 		break;
 
 	case Bang::Update:
-		KillTimer(m_Window, TIMER_METER);  // Kill timer temporarily
 		Update(false);
-		if (m_WindowUpdate >= 0)
-		{
-			SetTimer(m_Window, TIMER_METER, m_WindowUpdate, nullptr);
-		}
 		break;
 
 	case Bang::ShowBlur:
@@ -1431,8 +1464,7 @@ void MeterWindow::UpdateMeasure(const std::wstring& name, bool group)
 		{
 			if (bNetStats && (*i)->GetTypeID() == TypeID<MeasureNet>())
 			{
-				MeasureNet::UpdateIFTable();
-				MeasureNet::UpdateStats();
+				SystemMetrics::UpdateNetStats();
 				bNetStats = false;
 			}
 
@@ -2070,11 +2102,22 @@ bool MeterWindow::ReadSkin()
 	// Read options from Rainmeter.ini.
 	ReadOptions();
 
+	Timer parseTimer;
+	parseTimer.Start();
 	m_Parser.Initialize(iniFile, this, nullptr, &resourcePath);
+	parseTimer.Stop();
+
+	const Gfx::Renderer renderer =
+		m_UseD2D && GetRainmeter().GetUseD2D() ? Gfx::Renderer::PreferD2D : Gfx::Renderer::GDIP;
+	const bool accurateText = m_Parser.ReadBool(L"Rainmeter", L"AccurateText", false);
+	m_Canvas = Gfx::Canvas::Create(renderer);
+	m_Canvas->SetAccurateText(accurateText);
 
-	m_Canvas = Gfx::Canvas::Create(
-		m_UseD2D && GetRainmeter().GetUseD2D() ? Gfx::Renderer::PreferD2D : Gfx::Renderer::GDIP);
-	m_Canvas->SetAccurateText(m_Parser.ReadBool(L"Rainmeter", L"AccurateText", false));
+	// Meters are rendered into this for Meter::DrawCached(). It must be of the same type as
+	// |m_Canvas| since the text formats are shared.
+	m_CacheCanvas = Gfx::Canvas::Create(renderer);
+	m_CacheCanvas->SetAccurateText(accurateText);
+	m_CacheCanvas->Resize(1, 1);
 
 	// Gotta have some kind of buffer during initialization
 	CreateDoubleBuffer(1, 1);
@@ -2313,6 +2356,8 @@ bool MeterWindow::ReadSkin()
 	// Read measure options. This is done before the meters to ensure that e.g. Substitute is used
 	// when the meters get the value of the measure. The measures cannot be initialized yet as som
 	// measures (e.g. Script) except that the meters are ready when calling Initialize().
+	Timer optionsTimer;
+	optionsTimer.Start();
 	for (auto iter = m_Measures.cbegin(); iter != m_Measures.cend(); ++iter)
 	{
 		Measure* measure = *iter;
@@ -2332,12 +2377,23 @@ bool MeterWindow::ReadSkin()
 		}
 	}
 
+	optionsTimer.Stop();
+
 	// Initialize measures.
+	Timer initializeTimer;
+	initializeTimer.Start();
 	for (auto iter = m_Measures.cbegin(); iter != m_Measures.cend(); ++iter)
 	{
 		Measure* measure = *iter;
 		measure->Initialize();
 	}
+	initializeTimer.Stop();
+
+	if (GetRainmeter().GetDebug())
+	{
+		LogDebugF(this, L"Skin loaded: parse: %.2f ms, options: %.2f ms, initialize: %.2f ms",
+			parseTimer.GetElapsed(), optionsTimer.GetElapsed(), initializeTimer.GetElapsed());
+	}
 
 	// Set window size (and CURRENTCONFIGWIDTH/HEIGHT) temporarily
 	for (auto iter = m_Meters.cbegin(); iter != m_Meters.cend(); ++iter)
@@ -2537,10 +2593,88 @@ void MeterWindow::CreateDoubleBuffer(int cx, int cy)
 }
 
 /*
-** Redraws the meters and paints the window
+** Returns the area of the canvas that the meter paints to. Meters that may paint outside of their
+** bounds cover the whole canvas.
 **
 */
-void MeterWindow::Redraw()
+Rect MeterWindow::GetMeterDrawRect(Meter* meter)
+{
+	if (meter->IsHidden()) return Rect();
+
+	Rect rect;
+	if (!meter->GetDrawRect(rect))
+	{
+		return Rect(0, 0, m_Canvas->GetW(), m_Canvas->GetH());
+	}
+
+	const Matrix* matrix = meter->GetTransformationMatrix();
+	if (matrix && !matrix->IsIdentity())
+	{
+		Point points[4] =
+		{
+			Point(rect.GetLeft(), rect.GetTop()),
+			Point(rect.GetRight(), rect.GetTop()),
+			Point(rect.GetLeft(), rect.GetBottom()),
+			Point(rect.GetRight(), rect.GetBottom())
+		};
+		matrix->TransformPoints(points, 4);
+
+		int left = points[0].X, top = points[0].Y, right = points[0].X, bottom = points[0].Y;
+		for (int i = 1; i < 4; ++i)
+		{
+			left = min(left, points[i].X);
+			top = min(top, points[i].Y);
+			right = max(right, points[i].X);
+			bottom = max(bottom, points[i].Y);
+		}
+
+		// Allow for the rounding of the transformed points.
+		rect = Rect(left - 1, top - 1, right - left + 2, bottom - top + 2);
+	}
+
+	return rect;
+}
+
+/*
+** Adds to the number of repainted pixels and updates the per second rate.
+**
+*/
+void MeterWindow::AddRepaintedPixels(ULONGLONG pixels)
+{
+	m_RepaintedPixels += pixels;
+
+	const ULONGLONG now = System::GetTickCount64();
+	const ULONGLONG elapsed = now - m_RepaintedPixelsStartTime;
+	if (elapsed >= 1000)
+	{
+		m_RepaintedPixelsPerSecond = m_RepaintedPixels * 1000 / elapsed;
+		m_RepaintedPixels = 0;
+		m_RepaintedPixelsStartTime = now;
+
+		if (GetRainmeter().GetDebug())
+		{
+			LogDebugF(this, L"Repainted %llu pixels/s (%i x %i canvas)",
+				m_RepaintedPixelsPerSecond, m_Canvas->GetW(), m_Canvas->GetH());
+
+			if (m_PresentCount > 0)
+			{
+				LogDebugF(this, L"Presented %llu bytes/s in %u updates, %.3f ms per update",
+					m_PresentedBytes * 1000 / elapsed, m_PresentCount, m_PresentTime / m_PresentCount);
+			}
+		}
+
+		m_PresentedBytes = 0;
+		m_PresentTime = 0.0;
+		m_PresentCount = 0;
+	}
+}
+
+/*
+** Redraws the meters and paints the window. If |partial| is true, only the area of the meters
+** that have been updated, moved, resized, or hidden since the last redraw is repainted.
+**
+*/
+void MeterWindow::Redraw(bool partial)
 {
 	if (m_ResizeWindow)
 	{
@@ -2563,14 +2697,54 @@ void MeterWindow::Redraw()
 		if (cx != m_Canvas->GetW() || cy != m_Canvas->GetH())
 		{
 			CreateDoubleBuffer(cx, cy);
+			partial = false;
+		}
+	}
+
+	const Rect canvasRect(0, 0, m_Canvas->GetW(), m_Canvas->GetH());
+	Rect dirtyRect = canvasRect;
+
+	std::vector<Rect> drawRects;
+	drawRects.reserve(m_Meters.size());
+	for (auto j = m_Meters.cbegin(); j != m_Meters.cend(); ++j)
+	{
+		drawRects.push_back(GetMeterDrawRect(*j));
+	}
+
+	if (partial && m_MeterDrawRects.size() == drawRects.size())
+	{
+		dirtyRect = m_DirtyRect;
+		for (size_t i = 0, isize = drawRects.size(); i < isize; ++i)
+		{
+			if (!drawRects[i].Equals(m_MeterDrawRects[i]))
+			{
+				UnionRect(dirtyRect, m_MeterDrawRects[i]);
+				UnionRect(dirtyRect, drawRects[i]);
+			}
+		}
+
+		if (!Rect::Intersect(dirtyRect, dirtyRect, canvasRect))
+		{
+			// Nothing visible has changed.
+			m_DirtyRect = Rect();
+			return;
 		}
 	}
 
+	m_MeterDrawRects.swap(drawRects);
+	m_DirtyRect = Rect();
+
 	if (!m_Canvas->BeginDraw())
 	{
 		return;
 	}
 
+	const bool clip = !dirtyRect.Equals(canvasRect);
+	if (clip)
+	{
+		m_Canvas->SetClip(dirtyRect);
+	}
+
 	m_Canvas->Clear();
 
 	if (m_WindowW != 0 && m_WindowH != 0)
@@ -2622,24 +2796,33 @@ void MeterWindow::Redraw()
 		}
 
 		// Draw the meters
-		std::vector<Meter*>::const_iterator j = m_Meters.begin();
-		for ( ; j != m_Meters.end(); ++j)
+		for (size_t i = 0, isize = m_Meters.size(); i < isize; ++i)
 		{
-			const Matrix* matrix = (*j)->GetTransformationMatrix();
+			Meter* meter = m_Meters[i];
+			if (clip && !m_MeterDrawRects[i].IntersectsWith(dirtyRect)) continue;
+
+			const Matrix* matrix = meter->GetTransformationMatrix();
 			if (matrix && !matrix->IsIdentity())
 			{
 				m_Canvas->SetTransform(*matrix);
-				(*j)->Draw(*m_Canvas);
+				meter->Draw(*m_Canvas);
 				m_Canvas->ResetTransform();
 			}
 			else
 			{
-				(*j)->Draw(*m_Canvas);
+				meter->DrawCached(*m_Canvas, *m_CacheCanvas);
 			}
 		}
 	}
 
-	UpdateWindow(m_TransparencyValue, true);
+	if (clip)
+	{
+		m_Canvas->ResetClip();
+	}
+
+	AddRepaintedPixels((ULONGLONG)dirtyRect.Width * dirtyRect.Height);
+
+	UpdateWindow(m_TransparencyValue, true, clip ? &dirtyRect : nullptr);
 
 	m_Canvas->EndDraw();
 }
@@ -2706,10 +2889,21 @@ bool MeterWindow::UpdateMeter(Meter* meter, bool& bActiveTransition, bool force)
 		if (meter->HasDynamicVariables() &&
 			(meter->GetUpdateCounter() + 1) >= updateDivider)
 		{
-			meter->ReadOptions(m_Parser);
+			// Skip reading the options if none of the variables and measures they use has changed.
+			ConfigParser::Dependencies& dependencies = meter->GetOptionDependencies();
+			if (m_Parser.HaveDependenciesChanged(dependencies))
+			{
+				m_Parser.BeginDependencies(dependencies);
+				meter->ReadOptions(m_Parser);
+				m_Parser.EndDependencies();
+			}
 		}
 
 		bUpdate = meter->Update();
+		if (bUpdate)
+		{
+			meter->UpdateDrawCache();
+		}
 	}
 
 	// Update tooltips
@@ -2735,20 +2929,20 @@ bool MeterWindow::UpdateMeter(Meter* meter, bool& bActiveTransition, bool force)
 }
 
 /*
-** Updates all the measures and redraws the meters
+** Updates all the measures and redraws the meters. If |preUpdated| is true, the shared
+** pre-updates have already been done by the update timer.
 **
 */
-void MeterWindow::Update(bool refresh)
+void MeterWindow::Update(bool refresh, bool preUpdated)
 {
 	++m_UpdateCounter;
 
 	if (!m_Measures.empty())
 	{
 		// Pre-updates
-		if (m_HasNetMeasures)
+		if (m_HasNetMeasures && !preUpdated)
 		{
-			MeasureNet::UpdateIFTable();
-			MeasureNet::UpdateStats();
+			SystemMetrics::UpdateNetStats();
 		}
 
 		// Update all measures
@@ -2768,14 +2962,21 @@ void MeterWindow::Update(bool refresh)
 	// Update all meters
 	bool bActiveTransition = false;
 	bool bUpdate = false;
-	std::vector<Meter*>::const_iterator j = m_Meters.begin();
-	for ( ; j != m_Meters.end(); ++j)
+	for (size_t i = 0, isize = m_Meters.size(); i < isize; ++i)
 	{
-		if (UpdateMeter((*j), bActiveTransition, refresh))
+		Meter* meter = m_Meters[i];
+		if (UpdateMeter(meter, bActiveTransition, refresh))
 		{
 			bUpdate = true;
 
-			(*j)->DoUpdateAction();
+			// The previous contents must be repainted. Meters that moved or changed size are
+			// found in Redraw().
+			if (i < m_MeterDrawRects.size())
+			{
+				UnionRect(m_DirtyRect, m_MeterDrawRects[i]);
+			}
+
+			meter->DoUpdateAction();
 		}
 	}
 
@@ -2788,7 +2989,7 @@ void MeterWindow::Update(bool refresh)
 			SetResizeWindowMode(RESIZEMODE_CHECK);
 		}
 
-		Redraw();
+		Redraw(!refresh);
 	}
 
 	// Post-updates
@@ -2804,17 +3005,46 @@ void MeterWindow::Update(bool refresh)
 ** Updates the window contents
 **
 */
-void MeterWindow::UpdateWindow(int alpha, bool canvasBeginDrawCalled)
+void MeterWindow::UpdateWindow(int alpha, bool canvasBeginDrawCalled, const Rect* dirtyRect)
 {
 	BLENDFUNCTION blendPixelFunction = {AC_SRC_OVER, 0, alpha, AC_SRC_ALPHA};
 	POINT ptWindowScreenPosition = {m_ScreenX, m_ScreenY};
 	POINT ptSrc = {0, 0};
 	SIZE szWindow = {m_Canvas->GetW(), m_Canvas->GetH()};
 
+	const bool debug = GetRainmeter().GetDebug();
+	Timer presentTimer;
+	if (debug) presentTimer.Start();
+
 	if (!canvasBeginDrawCalled) m_Canvas->BeginDraw();
 
 	HDC dcMemory = m_Canvas->GetDC();
-	if (!UpdateLayeredWindow(m_Window, nullptr, &ptWindowScreenPosition, &szWindow, dcMemory, &ptSrc, 0, &blendPixelFunction, ULW_ALPHA))
+
+	// Only the dirty area needs to be copied to the window if the rest of the canvas has not
+	// changed since the last update.
+	bool updated = false;
+	ULONGLONG bytes = (ULONGLONG)szWindow.cx * szWindow.cy * 4;
+	if (dirtyRect && alpha == m_TransparencyValue)
+	{
+		RECT rcDirty = {dirtyRect->X, dirtyRect->Y, dirtyRect->GetRight(), dirtyRect->GetBottom()};
+
+		UPDATELAYEREDWINDOWINFO info = {sizeof(UPDATELAYEREDWINDOWINFO)};
+		info.pptDst = &ptWindowScreenPosition;
+		info.psize = &szWindow;
+		info.hdcSrc = dcMemory;
+		info.pptSrc = &ptSrc;
+		info.pblend = &blendPixelFunction;
+		info.dwFlags = ULW_ALPHA;
+		info.prcDirty = &rcDirty;
+		if (UpdateLayeredWindowIndirect(m_Window, &info))
+		{
+			updated = true;
+			bytes = (ULONGLONG)dirtyRect->Width * dirtyRect->Height * 4;
+		}
+	}
+
+	if (!updated &&
+		!UpdateLayeredWindow(m_Window, nullptr, &ptWindowScreenPosition, &szWindow, dcMemory, &ptSrc, 0, &blendPixelFunction, ULW_ALPHA))
 	{
 		// Retry after resetting WS_EX_LAYERED flag.
 		RemoveWindowExStyle(WS_EX_LAYERED);
@@ -2826,6 +3056,14 @@ void MeterWindow::UpdateWindow(int alpha, bool canvasBeginDrawCalled)
 	if (!canvasBeginDrawCalled) m_Canvas->EndDraw();
 
 	m_TransparencyValue = alpha;
+
+	if (debug)
+	{
+		presentTimer.Stop();
+		m_PresentTime += presentTimer.GetElapsed();
+		m_PresentedBytes += bytes;
+		++m_PresentCount;
+	}
 }
 
 /*
@@ -2848,10 +3086,6 @@ LRESULT MeterWindow::OnTimer(UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
 	switch (wParam)
 	{
-	case TIMER_METER:
-		Update(false);
-		break;
-
 	case TIMER_MOUSE:
 		if (!GetRainmeter().IsMenuActive() && !m_Dragging)
 		{
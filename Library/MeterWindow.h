@@ -131,7 +131,7 @@ public:
 	void UpdateMeasure(const std::wstring& name, bool group = false);
 	void Deactivate();
 	void Refresh(bool init, bool all = false);
-	void Redraw();
+	void Redraw(bool partial = false);
 	void RedrawWindow() { UpdateWindow(m_TransparencyValue); }
 	void SetVariable(const std::wstring& variable, const std::wstring& value);
 	void SetOption(const std::wstring& section, const std::wstring& option, const std::wstring& value, bool group);
@@ -168,6 +168,8 @@ public:
 	const std::vector<Measure*>& GetMeasures() { return m_Measures; }
 	const std::vector<Meter*>& GetMeters() { return m_Meters; }
 
+	ULONGLONG GetRepaintedPixelsPerSecond() { return m_RepaintedPixelsPerSecond; }
+
 	ZPOSITION GetWindowZPosition() { return m_WindowZPosition; }
 	bool GetXPercentage() { return m_WindowXPercentage; }
 	bool GetYPercentage() { return m_WindowYPercentage; }
@@ -194,6 +196,7 @@ public:
 	HIDEMODE GetWindowHide() { return m_WindowHide; }
 	int GetAlphaValue() { return m_AlphaValue; }
 	int GetUpdateCounter() { return m_UpdateCounter; }
+	bool HasNetMeasures() { return m_HasNetMeasures; }
 	int GetTransitionUpdate() { return m_TransitionUpdate; }
 
 	bool GetMeterToolTipHidden() { return m_ToolTipHidden; }
@@ -210,6 +213,7 @@ public:
 	Measure* GetMeasure(const std::wstring& measureName) { return m_Parser.GetMeasure(measureName); }
 
 	friend class DialogManage;
+	friend class Rainmeter;
 
 protected:
 	static LRESULT CALLBACK WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
@@ -289,8 +293,8 @@ private:
 	void PostUpdate(bool bActiveTransition);
 	bool UpdateMeasure(Measure* measure, bool force);
 	bool UpdateMeter(Meter* meter, bool& bActiveTransition, bool force);
-	void Update(bool refresh);
-	void UpdateWindow(int alpha, bool canvasBeginDrawCalled = false);
+	void Update(bool refresh, bool preUpdated = false);
+	void UpdateWindow(int alpha, bool canvasBeginDrawCalled = false, const Gdiplus::Rect* dirtyRect = nullptr);
 	void UpdateWindowTransparency(int alpha);
 	void ReadOptions();
 	void WriteOptions(INT setting = OPTION_ALL);
@@ -324,8 +328,11 @@ private:
 
 	void Dispose(bool refresh);
 	void CreateDoubleBuffer(int cx, int cy);
+	Gdiplus::Rect GetMeterDrawRect(Meter* meter);
+	void AddRepaintedPixels(ULONGLONG pixels);
 
 	Gfx::Canvas* m_Canvas;
+	Gfx::Canvas* m_CacheCanvas;		// Scratch canvas for Meter::DrawCached()
 
 	ConfigParser m_Parser;
 
@@ -414,6 +421,16 @@ private:
 
 	std::vector<Measure*> m_Measures;
 	std::vector<Meter*> m_Meters;
+	std::vector<Gdiplus::Rect> m_MeterDrawRects;	// Area of each meter at the last Redraw()
+	Gdiplus::Rect m_DirtyRect;						// Area of the meters updated since the last Redraw()
+
+	ULONGLONG m_RepaintedPixels;
+	ULONGLONG m_RepaintedPixelsStartTime;
+	ULONGLONG m_RepaintedPixelsPerSecond;
+
+	ULONGLONG m_PresentedBytes;						// Copied to the layered window since the last log
+	double m_PresentTime;
+	UINT m_PresentCount;
 
 	const std::wstring m_FolderPath;
 	const std::wstring m_FileName;
@@ -0,0 +1,75 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "StdAfx.h"
+#include "Meter.h"
+#include "Measure.h"
+#include "../Common/UnitTest.h"
+
+// Measure with a settable value and range.
+class RangeMeasure : public Measure
+{
+public:
+	RangeMeasure() : Measure(nullptr, L"Measure") { m_MinValue = 0.0; m_MaxValue = 100.0; }
+
+	void Set(double value, double minValue, double maxValue)
+	{
+		m_Value = value;
+		m_MinValue = minValue;
+		m_MaxValue = maxValue;
+	}
+
+protected:
+	virtual void UpdateValue() {}
+};
+
+TEST_CLASS(Library_Meter_Test)
+{
+public:
+	TEST_METHOD(TestDrawState)
+	{
+		RangeMeasure measure;
+		std::vector<Measure*> measures;
+		MeterDrawState state;
+
+		Assert::IsFalse(state.Update(measures, L""));
+
+		// Text set e.g. with SetText() without any bound measure.
+		Assert::IsTrue(state.Update(measures, L"abc"));
+		Assert::IsFalse(state.Update(measures, L"abc"));
+		Assert::IsTrue(state.Update(measures, L"def"));
+
+		measures.push_back(&measure);
+		measure.Set(50.0, 0.0, 100.0);
+		Assert::IsTrue(state.Update(measures, L"def"));
+		Assert::IsFalse(state.Update(measures, L"def"));
+
+		// The relative value changes with the range while the value stays the same.
+		measure.Set(50.0, 0.0, 200.0);
+		Assert::IsTrue(state.Update(measures, L"def"));
+		measure.Set(50.0, 25.0, 200.0);
+		Assert::IsTrue(state.Update(measures, L"def"));
+		Assert::IsFalse(state.Update(measures, L"def"));
+
+		measure.Set(60.0, 25.0, 200.0);
+		Assert::IsTrue(state.Update(measures, L"def"));
+
+		state.Clear();
+		Assert::IsTrue(state.Update(measures, L"def"));
+	}
+};
@@ -18,31 +18,40 @@
 
 #include "StdAfx.h"
 #include "../Common/PathUtil.h"
+#include "../Common/Timer.h"
 #include "Rainmeter.h"
 #include "System.h"
 #include "Error.h"
 #include "MeasureNet.h"
-#include "MeasureCPU.h"
+#include "SystemMetrics.h"
 #include "MeterString.h"
+#include "TintedImage.h"
 #include "../Version.h"
 
 using namespace Gdiplus;
 
 enum TIMER
 {
-	TIMER_NETSTATS = 1
+	TIMER_NETSTATS = 1,
+	TIMER_UPDATE   = 2
 };
 enum INTERVAL
 {
 	INTERVAL_NETSTATS = 120000
 };
 
+// Skins due within this many milliseconds of a tick are updated on it (about the resolution of
+// the system timer).
+const ULONGLONG UPDATE_TOLERANCE = 16;
+
 
 /*
 ** Constructor
 **
 */
 Rainmeter::Rainmeter() :
+m_UpdateScheduler(UPDATE_TOLERANCE),
+m_LoggedWakeupsPerSecond(),
 m_UseD2D(true),
 m_Debug(false),
 m_DesktopWorkAreaChanged(false),
@@ -126,7 +135,7 @@ int Rainmeter::Initialize()
 	System::Initialize(m_Instance);
 
 	MeasureNet::InitializeStatic();
-	MeasureCPU::InitializeStatic();
+	SystemMetrics::Initialize();
 	MeterString::InitializeStatic();
 
 	ResetStats();
@@ -144,6 +153,7 @@ int Rainmeter::Initialize()
 void Rainmeter::Finalize()
 {
 	KillTimer(m_Window, TIMER_NETSTATS);
+	KillTimer(m_Window, TIMER_UPDATE);
 
 	DeleteAllUnmanagedMeterWindows();
 	DeleteAllMeterWindows();
@@ -156,8 +166,9 @@ void Rainmeter::Finalize()
 	WriteStats(true);
 
 	MeasureNet::FinalizeStatic();
-	MeasureCPU::FinalizeStatic();
+	SystemMetrics::Finalize();
 	MeterString::FinalizeStatic();
+	TintedImage::FinalizeStatic();
 
 	// Change the work area back
 	if (m_DesktopWorkAreaChanged)
@@ -217,6 +228,10 @@ LRESULT CALLBACK Rainmeter::MainWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPA
 				MeasureNet::UpdateStats();
 				GetRainmeter().WriteStats(false);
 			}
+			else if (wParam == TIMER_UPDATE)
+			{
+				GetRainmeter().OnUpdateTimer();
+			}
 			break;
 
 		case WM_RAINMETER_DELAYED_REFRESH_ALL:
@@ -228,7 +243,11 @@ LRESULT CALLBACK Rainmeter::MainWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPA
 			{
 				// Execute bang
 				WCHAR* bang = (WCHAR*) lParam;
-				GetRainmeter().ExecuteCommand(bang, nullptr);
+				MeterWindow* meterWindow = (MeterWindow*) wParam;
+				if (!meterWindow || GetRainmeter().HasMeterWindow(meterWindow))
+				{
+					GetRainmeter().ExecuteCommand(bang, meterWindow);
+				}
 				free(bang);  // _wcsdup()
 			}
 			break;
@@ -252,6 +271,87 @@ void Rainmeter::SetNetworkStatisticsTimer()
 	static bool set = SetTimer(m_Window, TIMER_NETSTATS, INTERVAL_NETSTATS, nullptr) != 0;
 }
 
+/*
+** Updates the skin every |interval| milliseconds. All skins are updated from a single timer and
+** skins with the same interval are updated on the same tick.
+**
+*/
+void Rainmeter::ScheduleUpdate(MeterWindow* meterWindow, int interval)
+{
+	m_UpdateScheduler.Add(meterWindow, (std::max)(interval, USER_TIMER_MINIMUM), System::GetTickCount64());
+	SetUpdateTimer();
+}
+
+void Rainmeter::UnscheduleUpdate(MeterWindow* meterWindow)
+{
+	m_UpdateScheduler.Remove(meterWindow);
+	SetUpdateTimer();
+}
+
+/*
+** Updates the skins that are due. Shared pre-updates are done once for all of them.
+**
+*/
+void Rainmeter::OnUpdateTimer()
+{
+	std::vector<MeterWindow*> meterWindows;
+	m_UpdateScheduler.Collect(System::GetTickCount64(), meterWindows);
+
+	bool netStats = false;
+	for (auto meterWindow : meterWindows)
+	{
+		if (meterWindow->HasNetMeasures())
+		{
+			netStats = true;
+			break;
+		}
+	}
+
+	if (netStats)
+	{
+		SystemMetrics::UpdateNetStats();
+	}
+
+	for (auto meterWindow : meterWindows)
+	{
+		// The skin may have been deactivated by an earlier skin on this tick.
+		if (m_UpdateScheduler.Contains(meterWindow))
+		{
+			meterWindow->Update(false, true);
+		}
+	}
+
+	SetUpdateTimer();
+
+	if (m_Debug)
+	{
+		const int wakeupsPerSecond = (int)(m_UpdateScheduler.GetWakeupsPerSecond() + 0.5);
+		if (wakeupsPerSecond != m_LoggedWakeupsPerSecond)
+		{
+			m_LoggedWakeupsPerSecond = wakeupsPerSecond;
+			LogDebugF(L"Update timer: %i wakeups/s", wakeupsPerSecond);
+		}
+	}
+}
+
+/*
+** Sets the update timer to fire when the next skin is due.
+**
+*/
+void Rainmeter::SetUpdateTimer()
+{
+	if (m_UpdateScheduler.IsEmpty())
+	{
+		KillTimer(m_Window, TIMER_UPDATE);
+		return;
+	}
+
+	const ULONGLONG now = System::GetTickCount64();
+	const ULONGLONG next = m_UpdateScheduler.GetNextTime();
+	const UINT elapse = (next > now) ? (UINT)(next - now) : USER_TIMER_MINIMUM;
+	SetTimer(m_Window, TIMER_UPDATE, elapse, nullptr);
+}
+
 void Rainmeter::ActivateSkin(std::wstring file)
 {
 	file = NormalizePath(file);
@@ -491,13 +591,14 @@ void Rainmeter::ExecuteCommand(const WCHAR* command, MeterWindow* meterWindow, b
 }
 
 /*
-** Executes command when current processing is done.
+** Executes command when current processing is done. Can be called from any thread. The command
+** is dropped if the skin has been closed in the meantime.
 **
 */
-void Rainmeter::DelayedExecuteCommand(const WCHAR* command)
+void Rainmeter::DelayedExecuteCommand(const WCHAR* command, MeterWindow* meterWindow)
 {
 	WCHAR* bang = _wcsdup(command);
-	PostMessage(m_Window, WM_RAINMETER_DELAYED_EXECUTE, (WPARAM)nullptr, (LPARAM) bang);
+	PostMessage(m_Window, WM_RAINMETER_DELAYED_EXECUTE, (WPARAM)meterWindow, (LPARAM) bang);
 }
 
 /*
@@ -582,6 +683,11 @@ bool Rainmeter::LoadLayout(std::wstring filename)
 
 	m_DesktopWorkAreaType = parser.ReadBool(L"Rainmeter", L"DesktopWorkAreaType", false);
 
+	// Images no longer used are kept for reuse (e.g. on refresh) while all cached images fit
+	// within ImageCacheSize megabytes.
+	TintedImage::SetCacheBudget((ULONGLONG)parser.ReadUInt(L"Rainmeter", L"ImageCacheSize", 32) * 1024 * 1024);
+
+	std::vector<std::wstring> activeSkins;
 	for (auto iter = parser.GetSections().cbegin(); iter != parser.GetSections().end(); ++iter)
 	{
 		const WCHAR* section = (*iter).c_str();
@@ -595,15 +701,54 @@ bool Rainmeter::LoadLayout(std::wstring filename)
 		// Make sure there is a ini file available
 		int active = parser.ReadInt(section, L"Active", 0);
 		if (active > 0)
+		{
+			activeSkins.push_back(*iter);
+		}
+	}
+
+	// Parse the skin files on worker threads first. The skins are then activated one by one on
+	// this thread as creating windows, meters and measures (and initializing plugins) must be done
+	// here.
+	Timer prefetchTimer;
+	prefetchTimer.Start();
+	std::vector<std::wstring> skinFiles;
+	for (const auto& skin : activeSkins)
+	{
+		skinFiles.push_back(NormalizePath(skin));
+	}
+	ConfigParser::PrefetchIniFiles(skinFiles);
+	prefetchTimer.Stop();
+
+	Timer activateTimer;
+	activateTimer.Start();
+	try
+	{
+		for (auto iter = activeSkins.cbegin(); iter != activeSkins.cend(); ++iter)
 		{
 			// TODO: fix, get 'active'th file from *iter folder
 			ActivateSkin(*iter);
 
 			// TODO: activate using 'order'
-			int order = parser.ReadInt(section, L"LoadOrder", 0);
+			int order = parser.ReadInt((*iter).c_str(), L"LoadOrder", 0);
 			SetLoadOrder(*iter, order);
 		}
 	}
+	catch (...)
+	{
+		// Do not let later refreshes use the parsed files.
+		ConfigParser::ClearPrefetchedIniFiles();
+		throw;
+	}
+	activateTimer.Stop();
+
+	ConfigParser::ClearPrefetchedIniFiles();
+
+	if (m_Debug)
+	{
+		LogDebugF(L"Loaded %i skins: parse: %.2f ms, activate: %.2f ms",
+			(int)activeSkins.size(), prefetchTimer.GetElapsed(), activateTimer.GetElapsed());
+		TintedImage::LogCacheStats();
+	}
 
 	return true;
 }
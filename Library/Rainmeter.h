@@ -28,6 +28,7 @@
 #include "Logger.h"
 #include "MeterWindow.h"
 #include "../Common/PathUtil.h"
+#include "../Common/UpdateScheduler.h"
 
 #define MAX_LINE_LENGTH 4096
 
@@ -76,6 +77,9 @@ public:
 
 	void SetNetworkStatisticsTimer();
 
+	void ScheduleUpdate(MeterWindow* meterWindow, int interval);
+	void UnscheduleUpdate(MeterWindow* meterWindow);
+
 	ConfigParser* GetCurrentParser() { return m_CurrentParser; }
 	void SetCurrentParser(ConfigParser* parser) { m_CurrentParser = parser; }
 
@@ -145,7 +149,7 @@ public:
 
 	void ExecuteBang(const WCHAR* bang, std::vector<std::wstring>& args, MeterWindow* meterWindow);
 	void ExecuteCommand(const WCHAR* command, MeterWindow* meterWindow, bool multi = true);
-	void DelayedExecuteCommand(const WCHAR* command);
+	void DelayedExecuteCommand(const WCHAR* command, MeterWindow* meterWindow = nullptr);
 
 	void RefreshAll();
 
@@ -167,6 +171,9 @@ private:
 
 	static LRESULT CALLBACK MainWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
+	void OnUpdateTimer();
+	void SetUpdateTimer();
+
 	void CreateMeterWindow(std::wstring file);
 	void DeleteAllMeterWindows();
 	void DeleteAllUnmanagedMeterWindows();
@@ -183,6 +190,9 @@ private:
 	std::map<std::wstring, MeterWindow*> m_MeterWindows;
 	std::list<MeterWindow*> m_UnmanagedMeterWindows;
 
+	UpdateScheduler<MeterWindow> m_UpdateScheduler;
+	int m_LoggedWakeupsPerSecond;
+
 	std::wstring m_WorkDirectory;
 	bool m_UseCurrentDirectory;		// TODO: getter, setter
 	std::wstring m_StatsFile;	// TODO: getter, setter
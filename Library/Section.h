@@ -21,10 +21,10 @@
 
 #include <windows.h>
 #include <string>
+#include "ConfigParser.h"
 #include "Group.h"
 
 class MeterWindow;
-class ConfigParser;
 
 class __declspec(novtable) Section : public Group
 {
@@ -41,6 +41,8 @@ public:
 	bool HasDynamicVariables() const { return m_DynamicVariables; }
 	void SetDynamicVariables(bool b) { m_DynamicVariables = b; }
 
+	ConfigParser::Dependencies& GetOptionDependencies() { return m_OptionDependencies; }
+
 	void ResetUpdateCounter() { m_UpdateCounter = m_UpdateDivider; }
 	int GetUpdateCounter() const { return m_UpdateCounter; }
 	int GetUpdateDivider() const { return m_UpdateDivider; }
@@ -62,6 +64,7 @@ protected:
 	const std::wstring m_Name;
 
 	bool m_DynamicVariables;		// If true, the section contains dynamic variables
+	ConfigParser::Dependencies m_OptionDependencies;	// Inputs of the last dynamic ReadOptions()
 	int m_UpdateDivider;			// Divider for the update
 	int m_UpdateCounter;			// Current update counter
 
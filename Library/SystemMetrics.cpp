@@ -0,0 +1,232 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "StdAfx.h"
+#include "SystemMetrics.h"
+#include "MeasureNet.h"
+#include "System.h"
+
+#define STATUS_SUCCESS					0
+#define STATUS_INFO_LENGTH_MISMATCH		0xC0000004
+
+#define SystemProcessorPerformanceInformation	8
+
+typedef struct _SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION {
+    LARGE_INTEGER IdleTime;
+    LARGE_INTEGER KernelTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER Reserved1[2];
+    ULONG Reserved2;
+} SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION, *PSYSTEM_PROCESSOR_PERFORMANCE_INFORMATION;
+
+#define Li2Double(x) ((double)((x).QuadPart))
+#define Ft2Double(x) ((double)((x).dwHighDateTime) * 4.294967296E9 + (double)((x).dwLowDateTime))
+
+// Snapshots younger than this are shared. This is shorter than the shortest skin update interval
+// so that every update of a skin sees a new snapshot.
+const ULONGLONG MAX_SAMPLE_AGE = USER_TIMER_MINIMUM;
+
+MetricSampler<ProcessorTimes> SystemMetrics::c_SystemTimes(MAX_SAMPLE_AGE);
+MetricSampler<std::vector<ProcessorTimes>> SystemMetrics::c_ProcessorTimes(MAX_SAMPLE_AGE);
+MetricSampler<MEMORYSTATUSEX> SystemMetrics::c_MemoryStatus(MAX_SAMPLE_AGE);
+std::map<std::wstring, MetricSampler<DiskSpace>> SystemMetrics::c_DiskSpaces;
+MetricSampler<bool> SystemMetrics::c_NetStats(MAX_SAMPLE_AGE);
+
+FPNTQSI SystemMetrics::c_NtQuerySystemInformation = nullptr;
+int SystemMetrics::c_NumOfProcessors = 0;
+ULONG SystemMetrics::c_BufferSize = 0;
+
+void SystemMetrics::Initialize()
+{
+	c_NtQuerySystemInformation = (FPNTQSI)GetProcAddress(GetModuleHandle(L"ntdll"), "NtQuerySystemInformation");
+
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	c_NumOfProcessors = (int)systemInfo.dwNumberOfProcessors;
+}
+
+void SystemMetrics::Finalize()
+{
+	c_DiskSpaces.clear();
+}
+
+const ProcessorTimes* SystemMetrics::GetProcessorTimes(int processor, ULONGLONG& generation)
+{
+	const ULONGLONG now = System::GetTickCount64();
+	if (processor == 0)
+	{
+		const ProcessorTimes& times = c_SystemTimes.Get(now, ReadSystemTimes);
+		generation = c_SystemTimes.GetGeneration();
+		return (generation != 0) ? &times : nullptr;
+	}
+
+	const std::vector<ProcessorTimes>& times = c_ProcessorTimes.Get(now, ReadProcessorTimes);
+	generation = c_ProcessorTimes.GetGeneration();
+	return (processor <= (int)times.size()) ? &times[processor - 1] : nullptr;
+}
+
+const MEMORYSTATUSEX& SystemMetrics::GetMemoryStatus()
+{
+	return c_MemoryStatus.Get(System::GetTickCount64(), ReadMemoryStatus);
+}
+
+const DiskSpace& SystemMetrics::GetDiskSpace(const std::wstring& drive, bool diskQuota, bool ignoreRemovable)
+{
+	// The options change the result so they are part of the key.
+	std::wstring key = drive;
+	key += diskQuota ? L'1' : L'0';
+	key += ignoreRemovable ? L'1' : L'0';
+
+	auto it = c_DiskSpaces.find(key);
+	if (it == c_DiskSpaces.end())
+	{
+		it = c_DiskSpaces.insert(std::make_pair(key, MetricSampler<DiskSpace>(MAX_SAMPLE_AGE))).first;
+	}
+
+	return it->second.Get(System::GetTickCount64(), [&](DiskSpace& space)
+	{
+		return ReadDiskSpace(drive, diskQuota, ignoreRemovable, space);
+	});
+}
+
+void SystemMetrics::UpdateNetStats()
+{
+	c_NetStats.Get(System::GetTickCount64(), [](bool& updated)
+	{
+		MeasureNet::UpdateIFTable();
+		MeasureNet::UpdateStats();
+		updated = true;
+		return true;
+	});
+}
+
+bool SystemMetrics::ReadSystemTimes(ProcessorTimes& times)
+{
+	FILETIME ftIdleTime, ftKernelTime, ftUserTime;
+	if (!GetSystemTimes(&ftIdleTime, &ftKernelTime, &ftUserTime)) return false;
+
+	times.idle = Ft2Double(ftIdleTime);
+	times.system = Ft2Double(ftKernelTime) + Ft2Double(ftUserTime);
+	return true;
+}
+
+bool SystemMetrics::ReadProcessorTimes(std::vector<ProcessorTimes>& times)
+{
+	if (!c_NtQuerySystemInformation) return false;
+
+	LONG status;
+	ULONG bufSize = c_BufferSize;
+	BYTE* buf = (bufSize > 0) ? new BYTE[bufSize] : nullptr;
+
+	int loop = 0;
+
+	do
+	{
+		ULONG size = 0;
+
+		status = c_NtQuerySystemInformation(SystemProcessorPerformanceInformation, buf, bufSize, &size);
+		if (status == STATUS_INFO_LENGTH_MISMATCH)
+		{
+			if (size == 0)  // Returned required buffer size is always 0 on Windows 2000/XP.
+			{
+				if (bufSize == 0)
+				{
+					bufSize = sizeof(SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION) * c_NumOfProcessors;
+				}
+				else
+				{
+					bufSize += sizeof(SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION);
+				}
+			}
+			else
+			{
+				if (size != bufSize)
+				{
+					bufSize = size;
+				}
+				else  // ??
+				{
+					bufSize += sizeof(SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION);
+				}
+			}
+
+			delete [] buf;
+			buf = new BYTE[bufSize];
+		}
+		else
+		{
+			break;
+		}
+
+		++loop;
+	}
+	while (loop < 5);
+
+	if (status == STATUS_SUCCESS)
+	{
+		if (bufSize != c_BufferSize)
+		{
+			// Store the new buffer size
+			c_BufferSize = bufSize;
+		}
+
+		PSYSTEM_PROCESSOR_PERFORMANCE_INFORMATION systemPerfInfo = (PSYSTEM_PROCESSOR_PERFORMANCE_INFORMATION)buf;
+		const size_t count = bufSize / sizeof(SYSTEM_PROCESSOR_PERFORMANCE_INFORMATION);
+
+		times.resize(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			times[i].idle = Li2Double(systemPerfInfo[i].IdleTime);
+			times[i].system = Li2Double(systemPerfInfo[i].KernelTime) + Li2Double(systemPerfInfo[i].UserTime);
+		}
+	}
+
+	delete [] buf;
+	return status == STATUS_SUCCESS;
+}
+
+bool SystemMetrics::ReadMemoryStatus(MEMORYSTATUSEX& status)
+{
+	status.dwLength = sizeof(MEMORYSTATUSEX);
+	return GlobalMemoryStatusEx(&status) != FALSE;
+}
+
+bool SystemMetrics::ReadDiskSpace(const std::wstring& drive, bool diskQuota, bool ignoreRemovable, DiskSpace& space)
+{
+	space.type = GetDriveType(drive.c_str());
+	space.hasSize = false;
+
+	if (space.type != DRIVE_NO_ROOT_DIR &&
+		space.type != DRIVE_CDROM &&
+		(!ignoreRemovable || space.type != DRIVE_REMOVABLE))  // Ignore CD-ROMS and removable drives
+	{
+		BOOL result;
+		if (!diskQuota)
+		{
+			result = GetDiskFreeSpaceEx(drive.c_str(), nullptr, (PULARGE_INTEGER)&space.totalBytes, (PULARGE_INTEGER)&space.freeBytes);
+		}
+		else
+		{
+			result = GetDiskFreeSpaceEx(drive.c_str(), (PULARGE_INTEGER)&space.freeBytes, (PULARGE_INTEGER)&space.totalBytes, nullptr);
+		}
+
+		space.hasSize = result != FALSE;
+	}
+
+	return true;
+}
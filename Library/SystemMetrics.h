@@ -0,0 +1,87 @@
+/*
+  Copyright (C) 2013 Rainmeter Team
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __SYSTEMMETRICS_H__
+#define __SYSTEMMETRICS_H__
+
+#include <windows.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "../Common/MetricSampler.h"
+
+typedef LONG (WINAPI *FPNTQSI)(UINT, PVOID, ULONG, PULONG);
+
+struct ProcessorTimes
+{
+	double idle;
+	double system;		// Kernel and user time
+};
+
+struct DiskSpace
+{
+	UINT type;			// Result of GetDriveType
+	bool hasSize;		// False if the size was not read (e.g. removable drive or error)
+	ULONGLONG freeBytes;
+	ULONGLONG totalBytes;
+};
+
+// Reads the system metrics used by the CPU, memory, network and disk space measures. Each source
+// is read at most once per sampling interval and the snapshot is shared by the measures of all
+// skins, so e.g. per-core CPU measures in many skins do not each query the processor times.
+class SystemMetrics
+{
+public:
+	SystemMetrics(const SystemMetrics& other) = delete;
+	SystemMetrics& operator=(SystemMetrics other) = delete;
+
+	static void Initialize();
+	static void Finalize();
+
+	static int GetProcessorCount() { return c_NumOfProcessors; }
+
+	// Returns the times of |processor| (0 for all processors combined) or nullptr if they could
+	// not be read. |generation| is changed when the times are read again.
+	static const ProcessorTimes* GetProcessorTimes(int processor, ULONGLONG& generation);
+
+	static const MEMORYSTATUSEX& GetMemoryStatus();
+
+	// |drive| must have a trailing backslash.
+	static const DiskSpace& GetDiskSpace(const std::wstring& drive, bool diskQuota, bool ignoreRemovable);
+
+	// Reads the net interface table and updates the statistics of the net measures.
+	static void UpdateNetStats();
+
+private:
+	static bool ReadSystemTimes(ProcessorTimes& times);
+	static bool ReadProcessorTimes(std::vector<ProcessorTimes>& times);
+	static bool ReadMemoryStatus(MEMORYSTATUSEX& status);
+	static bool ReadDiskSpace(const std::wstring& drive, bool diskQuota, bool ignoreRemovable, DiskSpace& space);
+
+	static MetricSampler<ProcessorTimes> c_SystemTimes;
+	static MetricSampler<std::vector<ProcessorTimes>> c_ProcessorTimes;
+	static MetricSampler<MEMORYSTATUSEX> c_MemoryStatus;
+	static std::map<std::wstring, MetricSampler<DiskSpace>> c_DiskSpaces;
+	static MetricSampler<bool> c_NetStats;
+
+	static FPNTQSI c_NtQuerySystemInformation;
+	static int c_NumOfProcessors;
+	static ULONG c_BufferSize;
+};
+
+#endif
@@ -56,8 +56,11 @@ public:
 		std::unordered_map<std::wstring, ImageCache*>::const_iterator iter = c_CacheMap.find(key);
 		if (iter != c_CacheMap.end())
 		{
+			++c_Stats.hits;
 			return (*iter).second->GetCache();
 		}
+
+		++c_Stats.misses;
 		return nullptr;
 	}
 
@@ -66,47 +69,84 @@ public:
 		std::unordered_map<std::wstring, ImageCache*>::const_iterator iter = c_CacheMap.find(key);
 		if (iter != c_CacheMap.end())
 		{
-			(*iter).second->AddRef();
-			//LogDebugF(L"* ADD: key=%s, ref=%i", key.c_str(), (*iter).second->GetRef());
+			ImageCache* cache = (*iter).second;
+			if (cache->IsUnused())
+			{
+				c_Unused.erase(cache->GetUnusedIter());
+				c_Stats.unusedBytes -= cache->GetSize();
+			}
+
+			cache->AddRef();
+			//LogDebugF(L"* ADD: key=%s, ref=%i", key.c_str(), cache->GetRef());
 		}
 		else
 		{
-			c_CacheMap[key] = new ImageCache(bitmap, hBuffer);
+			ImageCache* cache = new ImageCache(bitmap, hBuffer);
+			c_CacheMap[key] = cache;
+			c_Stats.bytes += cache->GetSize();
 			//LogDebugF(L"* ADD: key=%s, ref=new", key.c_str());
+
+			Trim();
 		}
 	}
 
 	static void RemoveCache(const std::wstring& key)
 	{
-		std::unordered_map<std::wstring, ImageCache*>::const_iterator iter = c_CacheMap.find(key);
+		std::unordered_map<std::wstring, ImageCache*>::iterator iter = c_CacheMap.find(key);
 		if (iter != c_CacheMap.end())
 		{
 			ImageCache* cache = (*iter).second;
 			cache->Release();
 			//LogDebugF(L"* REMOVE: key=%s, ref=%i", key.c_str(), cache->GetRef());
 
-			if (cache->IsInvalid())
+			if (cache->IsUnused())
 			{
-				//LogDebugF(L"* EMPTY-ERASE: key=%s", key.c_str());
-				c_CacheMap.erase(iter);
-				delete cache;
+				if (c_Budget > 0)
+				{
+					// Keep the image for reuse (e.g. when the skin is refreshed).
+					c_Unused.push_front(key);
+					cache->SetUnusedIter(c_Unused.begin());
+					c_Stats.unusedBytes += cache->GetSize();
+					Trim();
+				}
+				else
+				{
+					//LogDebugF(L"* EMPTY-ERASE: key=%s", key.c_str());
+					Erase(iter);
+				}
 			}
 		}
 	}
 
+	static void SetBudget(ULONGLONG bytes)
+	{
+		c_Budget = bytes;
+		Trim();
+	}
+
+	static bool HasCache(const std::wstring& key) { return c_CacheMap.find(key) != c_CacheMap.end(); }
+
+	static const TintedImage::CacheStats& GetStats() { return c_Stats; }
+
 private:
 	class ImageCache
 	{
 	public:
-		ImageCache(Bitmap* bitmap, HGLOBAL hBuffer) : m_Bitmap(bitmap), m_hBuffer(hBuffer), m_Ref(1) {}
+		ImageCache(Bitmap* bitmap, HGLOBAL hBuffer) : m_Bitmap(bitmap), m_hBuffer(hBuffer), m_Ref(1),
+			m_Size((ULONGLONG)bitmap->GetWidth() * bitmap->GetHeight() * GetPixelFormatSize(bitmap->GetPixelFormat()) / 8 +
+				(hBuffer ? ::GlobalSize(hBuffer) : 0)) {}
 		~ImageCache() { Dispose(); }
 
 		void AddRef() { ++m_Ref; }
-		void Release() { if (m_Ref > 0) { --m_Ref; } if (m_Ref == 0) { Dispose(); } }
+		void Release() { if (m_Ref > 0) { --m_Ref; } }
 
-		bool IsInvalid() { return m_Ref == 0; }
+		bool IsUnused() { return m_Ref == 0; }
 		//int GetRef() { return m_Ref; }
 		Bitmap* GetCache() { return m_Bitmap; }
+		ULONGLONG GetSize() { return m_Size; }
+
+		std::list<std::wstring>::iterator GetUnusedIter() { return m_UnusedIter; }
+		void SetUnusedIter(std::list<std::wstring>::iterator iter) { m_UnusedIter = iter; }
 
 	private:
 		ImageCache() {}
@@ -117,11 +157,41 @@ private:
 		Bitmap* m_Bitmap;
 		HGLOBAL m_hBuffer;
 		int m_Ref;
+		const ULONGLONG m_Size;
+		std::list<std::wstring>::iterator m_UnusedIter;		// Position in c_Unused if unused
 	};
 
+	static void Erase(std::unordered_map<std::wstring, ImageCache*>::iterator iter)
+	{
+		ImageCache* cache = (*iter).second;
+		c_Stats.bytes -= cache->GetSize();
+		c_CacheMap.erase(iter);
+		delete cache;
+	}
+
+	// Deletes the least recently used unused images until the cache is within the budget.
+	static void Trim()
+	{
+		while (c_Stats.bytes > c_Budget && !c_Unused.empty())
+		{
+			std::unordered_map<std::wstring, ImageCache*>::iterator iter = c_CacheMap.find(c_Unused.back());
+			c_Unused.pop_back();
+
+			c_Stats.unusedBytes -= (*iter).second->GetSize();
+			++c_Stats.evictions;
+			Erase(iter);
+		}
+	}
+
 	static std::unordered_map<std::wstring, ImageCache*> c_CacheMap;
+	static std::list<std::wstring> c_Unused;		// Keys of the unused images, most recent first
+	static ULONGLONG c_Budget;
+	static TintedImage::CacheStats c_Stats;
 };
 std::unordered_map<std::wstring, ImageCachePool::ImageCache*> ImageCachePool::c_CacheMap;
+std::list<std::wstring> ImageCachePool::c_Unused;
+ULONGLONG ImageCachePool::c_Budget = 0;
+TintedImage::CacheStats ImageCachePool::c_Stats = {};
 
 
 #define PI	(3.14159265f)
@@ -146,6 +216,77 @@ const Gdiplus::ColorMatrix TintedImage::c_IdentityMatrix = {
 
 TintedImageHelper_DefineOptionArray(TintedImage::c_DefaultOptionArray, L"");
 
+volatile LONG TintedImage::c_PendingAsyncLoads = 0;
+
+// State shared by TintedImage::LoadImage() and the worker thread. |image| has a copy of the options
+// and owns the decoded bitmaps until they are taken by CompleteAsyncLoad().
+struct TintedImage::AsyncLoad
+{
+	AsyncLoad(const TintedImage& other) :
+		image(other.m_Name, other.m_OptionArray, other.m_DisableTransform),
+		hBuffer(),
+		done(0)
+	{
+		image.m_Crop = other.m_Crop;
+		image.m_CropMode = other.m_CropMode;
+		image.m_GreyScale = other.m_GreyScale;
+		*image.m_ColorMatrix = *other.m_ColorMatrix;
+		image.m_Flip = other.m_Flip;
+		image.m_Rotate = other.m_Rotate;
+		image.m_UseExifOrientation = other.m_UseExifOrientation;
+	}
+
+	~AsyncLoad()
+	{
+		delete image.m_Bitmap;
+		image.m_Bitmap = nullptr;
+
+		if (hBuffer) ::GlobalFree(hBuffer);
+	}
+
+	TintedImage image;
+	std::wstring filename;
+	std::wstring key;
+	HGLOBAL hBuffer;
+	volatile LONG done;		// Set by the worker when finished
+};
+
+/*
+** Sets the total size of the image cache up to which unused images are kept for reuse. Zero
+** releases images as soon as they are no longer used.
+**
+*/
+void TintedImage::SetCacheBudget(ULONGLONG bytes)
+{
+	ImageCachePool::SetBudget(bytes);
+}
+
+TintedImage::CacheStats TintedImage::GetCacheStats()
+{
+	return ImageCachePool::GetStats();
+}
+
+void TintedImage::LogCacheStats()
+{
+	const CacheStats& stats = ImageCachePool::GetStats();
+	LogDebugF(L"Image cache: %llu kB (%llu kB unused), %u hits, %u misses, %u evictions",
+		stats.bytes / 1024, stats.unusedBytes / 1024, stats.hits, stats.misses, stats.evictions);
+}
+
+/*
+** Releases the unused images. Must be called before GDI+ is shut down.
+**
+*/
+void TintedImage::FinalizeStatic()
+{
+	while (c_PendingAsyncLoads > 0)
+	{
+		Sleep(10);
+	}
+
+	ImageCachePool::SetBudget(0);
+}
+
 /*
 ** The constructor.
 **
@@ -189,8 +330,9 @@ TintedImage::~TintedImage()
 */
 void TintedImage::DisposeImage()
 {
-	delete m_BitmapTint;
-	m_BitmapTint = nullptr;
+	m_AsyncLoad.reset();
+
+	DisposeTintedImage();
 
 	m_Bitmap = nullptr;
 
@@ -201,6 +343,59 @@ void TintedImage::DisposeImage()
 	}
 }
 
+/*
+** Releases the tinted (or cropped, flipped, rotated) image.
+**
+*/
+void TintedImage::DisposeTintedImage()
+{
+	if (!m_TintCacheKey.empty())
+	{
+		ImageCachePool::RemoveCache(m_TintCacheKey);
+		m_TintCacheKey.clear();
+	}
+	else
+	{
+		delete m_BitmapTint;
+	}
+	m_BitmapTint = nullptr;
+}
+
+/*
+** Returns the cache pool key of the image derived from the source image with the current crop,
+** tint, and transform options. Tinted images with the same key are shared between meters.
+**
+*/
+std::wstring TintedImage::CreateTintCacheKey()
+{
+	std::wstring key = m_CacheKey;
+
+	WCHAR buffer[128];
+	size_t len = _snwprintf_s(buffer, _TRUNCATE, L"|%i,%i,%i,%i,%i|%i|%i|",
+		m_Crop.X, m_Crop.Y, m_Crop.Width, m_Crop.Height, (int)m_CropMode, (int)m_GreyScale, (int)m_Flip);
+	key.append(buffer, len);
+
+	// The bit patterns of the floats are used so that equal keys mean identical results.
+	auto appendFloat = [&](REAL value)
+	{
+		UINT bits;
+		memcpy(&bits, &value, sizeof(bits));
+		len = _snwprintf_s(buffer, _TRUNCATE, L"%x,", bits);
+		key.append(buffer, len);
+	};
+
+	for (int i = 0; i < 5; ++i)
+	{
+		for (int j = 0; j < 4; ++j)  // The fifth column is reserved.
+		{
+			appendFloat(m_ColorMatrix->m[i][j]);
+		}
+	}
+	appendFloat(m_Rotate);
+
+	return key;
+}
+
 /*
 ** Loads the image from file handle
 **
@@ -310,11 +505,18 @@ Bitmap* TintedImage::LoadImageFromFileHandle(HANDLE fileHandle, DWORD fileSize,
 }
 
 /*
-** Loads the image from disk
+** Loads the image from disk. If |async| is true and an image is already loaded, a new image that
+** is not in the cache is decoded (and tinted, cropped, etc.) on a worker thread. The current
+** image is kept until a later call finds the new image ready.
 **
 */
-void TintedImage::LoadImage(const std::wstring& imageName, bool bLoadAlways)
+void TintedImage::LoadImage(const std::wstring& imageName, bool bLoadAlways, bool async)
 {
+	if (m_AsyncLoad && InterlockedCompareExchange(&m_AsyncLoad->done, 0, 0) != 0)
+	{
+		CompleteAsyncLoad();
+	}
+
 	// Load the bitmap if defined
 	if (!imageName.empty())
 	{
@@ -341,74 +543,44 @@ void TintedImage::LoadImage(const std::wstring& imageName, bool bLoadAlways)
 
 			if (bLoadAlways || wcscmp(key.c_str(), m_CacheKey.c_str()) != 0)
 			{
+				if (async && m_Bitmap && !ImageCachePool::HasCache(key))
+				{
+					if (!m_AsyncLoad || m_AsyncLoad->key != key)
+					{
+						StartAsyncLoad(filename, key);
+					}
+
+					CloseHandle(fileHandle);
+					return;
+				}
+
 				DisposeImage();
 
 				Bitmap* bitmap = ImageCachePool::GetCache(key);
 				HGLOBAL hBuffer = nullptr;
 
-				m_Bitmap = (bitmap) ?
-					bitmap :
-					LoadImageFromFileHandle(fileHandle, fileSize, &hBuffer);
-
-				if (m_Bitmap)
+				if (!bitmap)
 				{
-					m_CacheKey = key;
-					ImageCachePool::AddCache(key, m_Bitmap, hBuffer);
+					bitmap = LoadImageFromFileHandle(fileHandle, fileSize, &hBuffer);
+				}
 
-					// Check whether the new image needs tinting (or cropping, flipping, rotating)
-					if (!m_NeedsCrop)
-					{
-						if (m_Crop.Width >= 0 || m_Crop.Height >= 0)
-						{
-							m_NeedsCrop = true;
-						}
-					}
-					if (!m_NeedsTinting)
-					{
-						if (m_GreyScale || !CompareColorMatrix(m_ColorMatrix, &c_IdentityMatrix))
-						{
-							m_NeedsTinting = true;
-						}
-					}
-					if (!m_NeedsTransform)
-					{
-						if (m_Flip != RotateNoneFlipNone || m_Rotate != 0.0f)
-						{
-							m_NeedsTransform = true;
-						}
-					}
+				if (bitmap)
+				{
+					SetSourceImage(key, bitmap, hBuffer);
 				}
 				else
 				{
 					LogErrorF(m_MeterWindow, L"%s: Unable to load: %s", m_Name, filename.c_str());
 				}
 			}
-			CloseHandle(fileHandle);
-
-			if (m_Bitmap)
+			else
 			{
-				// We need a copy of the image if has tinting (or flipping, rotating)
-				if (m_NeedsCrop || m_NeedsTinting || m_NeedsTransform)
-				{
-					delete m_BitmapTint;
-					m_BitmapTint = nullptr;
-
-					if (m_Bitmap->GetWidth() > 0 && m_Bitmap->GetHeight() > 0)
-					{
-						ApplyCrop();
-
-						if (!m_BitmapTint || (m_BitmapTint->GetWidth() > 0 && m_BitmapTint->GetHeight() > 0))
-						{
-							ApplyTint();
-							ApplyTransform();
-						}
-					}
-
-					m_NeedsCrop = false;
-					m_NeedsTinting = false;
-					m_NeedsTransform = false;
-				}
+				// The current image is wanted again.
+				m_AsyncLoad.reset();
 			}
+			CloseHandle(fileHandle);
+
+			UpdateTintedImage();
 		}
 		else
 		{
@@ -421,12 +593,198 @@ void TintedImage::LoadImage(const std::wstring& imageName, bool bLoadAlways)
 			DisposeImage();
 		}
 	}
-	else if (IsLoaded())
+	else if (IsLoaded() || m_AsyncLoad)
 	{
 		DisposeImage();
 	}
 }
 
+/*
+** Sets the (shared) source image and checks whether it needs tinting (or cropping, flipping,
+** rotating).
+**
+*/
+void TintedImage::SetSourceImage(const std::wstring& key, Bitmap* bitmap, HGLOBAL hBuffer)
+{
+	m_Bitmap = bitmap;
+	m_CacheKey = key;
+	ImageCachePool::AddCache(key, m_Bitmap, hBuffer);
+
+	if (!m_NeedsCrop)
+	{
+		if (m_Crop.Width >= 0 || m_Crop.Height >= 0)
+		{
+			m_NeedsCrop = true;
+		}
+	}
+	if (!m_NeedsTinting)
+	{
+		if (m_GreyScale || !CompareColorMatrix(m_ColorMatrix, &c_IdentityMatrix))
+		{
+			m_NeedsTinting = true;
+		}
+	}
+	if (!m_NeedsTransform)
+	{
+		if (m_Flip != RotateNoneFlipNone || m_Rotate != 0.0f)
+		{
+			m_NeedsTransform = true;
+		}
+	}
+}
+
+/*
+** Recreates (or finds in the cache) the tinted image if the options have changed.
+**
+*/
+void TintedImage::UpdateTintedImage()
+{
+	if (m_Bitmap)
+	{
+		// We need a copy of the image if has tinting (or flipping, rotating)
+		if (m_NeedsCrop || m_NeedsTinting || m_NeedsTransform)
+		{
+			DisposeTintedImage();
+
+			if (m_Bitmap->GetWidth() > 0 && m_Bitmap->GetHeight() > 0)
+			{
+				// Reuse the result of another image with the same source and options.
+				const std::wstring tintKey = CreateTintCacheKey();
+				m_BitmapTint = ImageCachePool::GetCache(tintKey);
+				if (!m_BitmapTint)
+				{
+					ApplyOptions();
+				}
+
+				if (m_BitmapTint)
+				{
+					m_TintCacheKey = tintKey;
+					ImageCachePool::AddCache(tintKey, m_BitmapTint, nullptr);
+				}
+			}
+
+			m_NeedsCrop = false;
+			m_NeedsTinting = false;
+			m_NeedsTransform = false;
+		}
+	}
+}
+
+/*
+** Creates the tinted image from m_Bitmap, which must not be empty.
+**
+*/
+void TintedImage::ApplyOptions()
+{
+	ApplyCrop();
+
+	if (!m_BitmapTint || (m_BitmapTint->GetWidth() > 0 && m_BitmapTint->GetHeight() > 0))
+	{
+		ApplyTint();
+		ApplyTransform();
+	}
+}
+
+/*
+** Starts decoding |filename| on a worker thread with a copy of the current options.
+**
+*/
+void TintedImage::StartAsyncLoad(const std::wstring& filename, const std::wstring& key)
+{
+	m_AsyncLoad = std::make_shared<AsyncLoad>(*this);
+	m_AsyncLoad->filename = filename;
+	m_AsyncLoad->key = key;
+
+	InterlockedIncrement(&c_PendingAsyncLoads);
+
+	// The worker keeps its own reference in case this image is disposed in the meantime.
+	std::shared_ptr<AsyncLoad>* param = new std::shared_ptr<AsyncLoad>(m_AsyncLoad);
+	if (!QueueUserWorkItem(AsyncLoadThreadProc, param, WT_EXECUTEDEFAULT))
+	{
+		AsyncLoadThreadProc(param);
+	}
+}
+
+DWORD WINAPI TintedImage::AsyncLoadThreadProc(void* param)
+{
+	std::shared_ptr<AsyncLoad>* load = (std::shared_ptr<AsyncLoad>*)param;
+	TintedImage& image = (*load)->image;
+
+	HANDLE fileHandle = CreateFile((*load)->filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+		DWORD fileSize = GetFileSize(fileHandle, nullptr);
+		if (fileSize != INVALID_FILE_SIZE)
+		{
+			image.m_Bitmap = image.LoadImageFromFileHandle(fileHandle, fileSize, &(*load)->hBuffer);
+			if (image.m_Bitmap && image.m_Bitmap->GetWidth() > 0 && image.m_Bitmap->GetHeight() > 0)
+			{
+				image.ApplyOptions();
+			}
+		}
+		CloseHandle(fileHandle);
+	}
+
+	InterlockedExchange(&(*load)->done, 1);
+	delete load;
+
+	InterlockedDecrement(&c_PendingAsyncLoads);
+	return 0;
+}
+
+/*
+** Replaces the current image with the result of the finished asynchronous load.
+**
+*/
+void TintedImage::CompleteAsyncLoad()
+{
+	std::shared_ptr<AsyncLoad> load;
+	load.swap(m_AsyncLoad);
+	TintedImage& image = load->image;
+
+	DisposeImage();
+
+	if (!image.m_Bitmap)
+	{
+		LogErrorF(m_MeterWindow, L"%s: Unable to load: %s", m_Name, load->filename.c_str());
+		return;
+	}
+
+	// Another image may have loaded the same file in the meantime.
+	Bitmap* bitmap = ImageCachePool::GetCache(load->key);
+	if (bitmap)
+	{
+		SetSourceImage(load->key, bitmap, nullptr);
+	}
+	else
+	{
+		SetSourceImage(load->key, image.m_Bitmap, load->hBuffer);
+		image.m_Bitmap = nullptr;
+		load->hBuffer = nullptr;
+	}
+
+	// Use the tinted image of the worker unless the options have changed since it was started.
+	image.m_CacheKey = load->key;
+	if (image.m_BitmapTint)
+	{
+		const std::wstring tintKey = CreateTintCacheKey();
+		if (tintKey == image.CreateTintCacheKey() && !ImageCachePool::HasCache(tintKey))
+		{
+			m_BitmapTint = image.m_BitmapTint;
+			image.m_BitmapTint = nullptr;
+			m_TintCacheKey = tintKey;
+			ImageCachePool::AddCache(tintKey, m_BitmapTint, nullptr);
+
+			m_NeedsCrop = false;
+			m_NeedsTinting = false;
+			m_NeedsTransform = false;
+		}
+	}
+	image.m_CacheKey.clear();
+
+	UpdateTintedImage();
+}
+
 /*
 ** This will apply the cropping.
 **
@@ -22,6 +22,7 @@
 #include <windows.h>
 #include <ole2.h>  // For Gdiplus.h.
 #include <gdiplus.h>
+#include <memory>
 #include <string>
 #include "MeterWindow.h"
 
@@ -70,6 +71,15 @@ public:
 		OptionCount
 	};
 
+	struct CacheStats
+	{
+		ULONGLONG bytes;		// All cached images
+		ULONGLONG unusedBytes;	// Images kept after their last use
+		UINT hits;
+		UINT misses;
+		UINT evictions;
+	};
+
 	TintedImage(const WCHAR* name = L"ImageName", const WCHAR** optionArray = c_DefaultOptionArray, bool disableTransform = false, MeterWindow* meterWindow = nullptr);
 	~TintedImage();
 
@@ -88,7 +98,13 @@ public:
 	Gdiplus::Bitmap* GetImage() { return (m_BitmapTint) ? m_BitmapTint : m_Bitmap; }
 
 	void DisposeImage();
-	void LoadImage(const std::wstring& imageName, bool bLoadAlways);
+	void LoadImage(const std::wstring& imageName, bool bLoadAlways, bool async = false);
+
+	static void SetCacheBudget(ULONGLONG bytes);
+	static CacheStats GetCacheStats();
+	static void LogCacheStats();
+
+	static void FinalizeStatic();
 
 protected:
 	enum CROPMODE
@@ -104,13 +120,25 @@ protected:
 	void ApplyTint();
 	void ApplyTransform();
 
+	std::wstring CreateTintCacheKey();
+	void DisposeTintedImage();
+
+	void SetSourceImage(const std::wstring& key, Gdiplus::Bitmap* bitmap, HGLOBAL hBuffer);
+	void UpdateTintedImage();
+	void ApplyOptions();
+
+	struct AsyncLoad;
+	void StartAsyncLoad(const std::wstring& filename, const std::wstring& key);
+	void CompleteAsyncLoad();
+	static DWORD WINAPI AsyncLoadThreadProc(void* param);
+
 	Gdiplus::Bitmap* LoadImageFromFileHandle(HANDLE fileHandle, DWORD fileSize, HGLOBAL* phBuffer);
 
 	static Gdiplus::Bitmap* TurnGreyscale(Gdiplus::Bitmap* source);
 	static bool CompareColorMatrix(const Gdiplus::ColorMatrix* a, const Gdiplus::ColorMatrix* b);
 
 	Gdiplus::Bitmap* m_Bitmap;
-	Gdiplus::Bitmap* m_BitmapTint;		// Tinted bitmap
+	Gdiplus::Bitmap* m_BitmapTint;		// Tinted bitmap, shared through the cache pool
 
 	const WCHAR* m_Name;
 	const WCHAR** m_OptionArray;
@@ -132,6 +160,9 @@ protected:
 	bool m_HasPathChanged;
 
 	std::wstring m_CacheKey;
+	std::wstring m_TintCacheKey;
+
+	std::shared_ptr<AsyncLoad> m_AsyncLoad;		// Pending load started by LoadImage()
 
 	MeterWindow* m_MeterWindow;
 
@@ -139,6 +170,8 @@ protected:
 	static const Gdiplus::ColorMatrix c_IdentityMatrix;
 
 	static const WCHAR* c_DefaultOptionArray[OptionCount];
+
+	static volatile LONG c_PendingAsyncLoads;
 };
 
 #endif
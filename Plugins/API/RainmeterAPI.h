@@ -30,6 +30,12 @@
 //
 // Exported functions
 //
+// Calls into a plugin (Initialize, Reload, Update, GetString, ExecuteBang and Finalize) are
+// never made concurrently, even if several measures use the plugin. With UpdateAsync=1, Update
+// and GetString run on a worker thread. Only RmGet, RmLog, RmLogF, LSLog and RmExecute may be
+// called there: RmExecute runs the command later on the main thread and the RmRead*,
+// RmReplaceVariables and RmPathToAbsolute functions log an error and return their input.
+//
 
 #ifdef __cplusplus
 LIBRARY_EXPORT LPCWSTR __stdcall RmReadString(void* rm, LPCWSTR option, LPCWSTR defValue, BOOL replaceMeasures = TRUE);